@@ -0,0 +1,281 @@
+/*
+    AllocationCheck
+
+    Checks that dragging across a ColourSelector, and the background renders it
+    asks for, don't allocate once they are under way. The global operator new is
+    replaced with one that counts, and the count is taken while:
+
+      - the events of a drag across the colour plane and the strip are sent to a
+        selector, which stores the colour in its model, updates its widgets and
+        decides what to repaint. The selector is then painted, as the screen would
+        be, which asks the RenderScheduler for new images of the plane and strip.
+        They are rendered on its workers and delivered on the message thread, and
+        all of that is counted. Only the painting itself, on the message thread,
+        isn't, as JUCE's renderer allocates.
+
+      - renders are requested from the RenderScheduler, run on its workers, and
+        delivered on the message thread. The drag makes its requests while it
+        is painted, so this checks the requests on their own.
+
+    The first few of each are left out, while the pools and lists fill up. The
+    exit code is 0 if nothing was allocated, so the check can run as a test.
+
+        AllocationCheck [--events 200]
+
+    Allocations with extended alignment aren't counted.
+*/
+
+#include <refx_colourselector/refx_colourselector.h>
+
+#include <iostream>
+#include <thread>
+
+namespace
+{
+    enum class Counting
+    {
+        none,
+        allThreads,
+        otherThreads    // all but the message thread, while it paints
+    };
+
+    std::atomic<Counting> counting { Counting::none };
+    std::atomic<int> numAllocations { 0 };
+    std::thread::id messageThread;
+
+    void* allocate (std::size_t size)
+    {
+        auto mode = counting.load (std::memory_order_relaxed);
+
+        if (mode == Counting::allThreads || (mode == Counting::otherThreads && std::this_thread::get_id() != messageThread))
+            ++numAllocations;
+
+        if (auto* p = std::malloc (size == 0 ? 1 : size))
+            return p;
+
+        throw std::bad_alloc();
+    }
+
+    /** Counts the allocations made while it exists. */
+    struct ScopedCount
+    {
+        explicit ScopedCount (Counting mode = Counting::allThreads)    { counting = mode; }
+        ~ScopedCount()                                                  { counting = Counting::none; }
+    };
+}
+
+void* operator new (std::size_t size)                                   { return allocate (size); }
+void* operator new[] (std::size_t size)                                 { return allocate (size); }
+void* operator new (std::size_t size, const std::nothrow_t&) noexcept   { try { return allocate (size); } catch (...) { return nullptr; } }
+void* operator new[] (std::size_t size, const std::nothrow_t&) noexcept { try { return allocate (size); } catch (...) { return nullptr; } }
+void operator delete (void* p) noexcept                                 { std::free (p); }
+void operator delete[] (void* p) noexcept                               { std::free (p); }
+void operator delete (void* p, std::size_t) noexcept                    { std::free (p); }
+void operator delete[] (void* p, std::size_t) noexcept                  { std::free (p); }
+
+namespace
+{
+    constexpr int numWarmUpEvents = 20;
+
+    //==============================================================================
+    void runMessageLoop (int milliseconds)
+    {
+        juce::MessageManager::getInstance()->runDispatchLoopUntil (milliseconds);
+    }
+
+    /** Paints the whole selector, as a screen refresh would. */
+    void paint (reFX::ColourSelector& selector)
+    {
+        selector.createComponentSnapshot (selector.getLocalBounds());
+    }
+
+    /** Waits until the images the selector asked for have been delivered. */
+    void waitForRenders()
+    {
+        juce::SharedResourcePointer<reFX::RenderScheduler> scheduler;
+
+        while (scheduler->getNumJobs() > 0)
+            runMessageLoop (1);
+    }
+
+    /** Paints the selector and waits for its images, as often as it asks for new
+        ones. The first paint that asks for nothing shows the delivered images.
+
+        While counting, the allocations of the workers are counted throughout, and
+        those of the message thread only while it waits and delivers.
+    */
+    void paintAndWait (reFX::ColourSelector& selector, bool count)
+    {
+        juce::SharedResourcePointer<reFX::RenderScheduler> scheduler;
+
+        for (;;)
+        {
+            {
+                std::optional<ScopedCount> scope;
+
+                if (count)
+                    scope.emplace (Counting::otherThreads);
+
+                paint (selector);
+            }
+
+            if (scheduler->getNumJobs() == 0)
+                return;
+
+            std::optional<ScopedCount> scope;
+
+            if (count)
+                scope.emplace();
+
+            waitForRenders();
+        }
+    }
+
+    /** Returns a drag along a diagonal of the plane, then one along the strip. */
+    reFX::DragTrace createTrace (int flags, int numEvents)
+    {
+        reFX::DragTrace trace;
+        trace.flags = flags;
+        trace.colour = reFX::DeepColour::fromRGBA (0.8f, 0.35f, 0.2f, 1.0f);
+
+        for (auto target : { reFX::DragTrace::Target::plane, reFX::DragTrace::Target::strip })
+        {
+            for (int i = 0; i < numEvents; ++i)
+            {
+                auto t = (float) i / (float) (numEvents - 1);
+
+                reFX::DragTrace::Event e;
+                e.target = target;
+                e.phase = i == 0 ? reFX::DragTrace::Phase::down
+                                 : (i == numEvents - 1 ? reFX::DragTrace::Phase::up : reFX::DragTrace::Phase::drag);
+                e.position = { 0.1f + 0.8f * t, 0.9f - 0.8f * t };
+
+                trace.events.push_back (e);
+            }
+        }
+
+        return trace;
+    }
+
+    /** Returns the number of allocations made by the drag events, and by the renders
+        and deliveries they lead to, after the first few events of each drag.
+    */
+    int checkDrag (int numEvents)
+    {
+        const auto flags = reFX::ColourSelector::showColourspace;
+
+        reFX::ColourSelector selector (flags);
+        selector.setSize (300, 300);
+
+        // each drag is pressed, moved through the warm-up and counted events, and released
+        auto trace = createTrace (flags, numWarmUpEvents + numEvents + 2);
+        reFX::DragTrace::Player player (selector, trace);
+
+        paintAndWait (selector, false);
+
+        int count = 0;
+        int numDragged = 0;
+
+        for (auto& e : trace.events)
+        {
+            if (e.phase == reFX::DragTrace::Phase::down)
+                numDragged = 0;
+
+            // the first events of each drag fill the pools, and pressing and
+            // releasing the mouse can allocate, for example to grab the focus
+            auto counted = e.phase == reFX::DragTrace::Phase::drag && ++numDragged > numWarmUpEvents;
+
+            numAllocations = 0;
+
+            {
+                std::optional<ScopedCount> scope;
+
+                if (counted)
+                    scope.emplace();
+
+                player.play (e);
+            }
+
+            paintAndWait (selector, counted);
+            count += numAllocations;
+        }
+
+        return count;
+    }
+
+    /** Returns the number of allocations made by requesting, rendering and delivering images.
+
+        The drag check counts the real renders, but not the requests, as they are made
+        while painting. A trivial render is enough here, as it is the scheduler's own
+        work that is counted.
+    */
+    int checkScheduler (int numRequests)
+    {
+        reFX::RenderScheduler::Target target;
+        juce::Image image (juce::Image::RGB, 64, 64, true);
+
+        int numDelivered = 0;
+        target.onRenderFinished = [&numDelivered] (const juce::Image&) { ++numDelivered; };
+
+        int count = 0;
+
+        for (int i = 0; i < numRequests + numWarmUpEvents; ++i)
+        {
+            numAllocations = 0;
+            auto delivered = numDelivered;
+
+            {
+                std::optional<ScopedCount> scope;
+
+                if (i >= numWarmUpEvents)
+                    scope.emplace();
+
+                // a new key for each request, as each frame of a drag asks for a different image
+                target.requestRender (reFX::RenderScheduler::Priority::interacting, i, [image] { return image; });
+
+                while (numDelivered == delivered)
+                    runMessageLoop (1);
+            }
+
+            count += numAllocations;
+        }
+
+        return count;
+    }
+
+    void printUsage()
+    {
+        std::cerr << "Checks that dragging in a reFX ColourSelector, and the renders it asks for, don't allocate.\n\n"
+                     "AllocationCheck [options]\n\n"
+                     "Options:\n"
+                     "  --events <n>     the number of counted events of each kind (200)\n";
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI initialiser;
+    juce::ArgumentList args (argc, argv);
+
+    messageThread = std::this_thread::get_id();
+
+    if (args.containsOption ("--help|-h"))
+    {
+        printUsage();
+        return 0;
+    }
+
+    auto numEvents = 200;
+
+    if (args.containsOption ("--events"))
+        numEvents = juce::jmax (1, args.getValueForOption ("--events").getIntValue());
+
+    auto dragAllocations = checkDrag (numEvents);
+    auto schedulerAllocations = checkScheduler (numEvents);
+
+    std::cout << (dragAllocations == 0 ? "pass  " : "FAIL  ") << "drag events:       " << dragAllocations << " allocations\n"
+              << (schedulerAllocations == 0 ? "pass  " : "FAIL  ") << "scheduled renders: " << schedulerAllocations << " allocations\n";
+
+    return dragAllocations == 0 && schedulerAllocations == 0 ? 0 : 1;
+}
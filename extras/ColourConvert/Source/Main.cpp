@@ -0,0 +1,680 @@
+/*
+    ColourConvert
+
+    Converts colour tables between spaces with the same DeepColour code that the
+    colour selector uses, so a table converted here matches what the selector shows.
+
+    The input is read one record per line: a hex colour or CSS colour name, or three
+    or four numbers separated by commas or spaces. The brackets, quotes and commas of
+    JSON and CSV around a record are ignored, so a JSON array with one colour per line
+    reads like a plain list. Lines without a colour are skipped: those that are only
+    brackets, JSON keys such as "colours": [, and a header on the first line of a CSV
+    file. Any other line that can't be read is reported, gets an empty row, or null in
+    JSON, and makes the exit code 1.
+
+    The input is read in blocks of batches on one thread, the batches are converted
+    on the shared WorkerPool, and the results are written in input order on another
+    thread. Only a few blocks exist, and they are reused, so the memory used doesn't
+    grow with the size of the table.
+
+        ColourConvert --from hex --to oklab [--format csv|json] [--batch 8192]
+                      [--input colours.txt] [--output converted.csv] [--quiet]
+*/
+
+#include <refx_colourselector/refx_colourselector.h>
+
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+    //==============================================================================
+    enum class Space
+    {
+        hex,        // #RRGGBB or #RRGGBBAA, or a CSS colour name when reading
+        rgb,        // sRGB, 0 to 1
+        rgb8,       // sRGB, 0 to 255
+        hsb,        // hue, saturation and brightness, 0 to 1
+        oklab,
+        lab,        // CIE L*a*b*, D65
+        linear,     // linear light sRGB, 0 to 1
+        p3,         // Display P3, 0 to 1
+        name,       // the nearest CSS colour name
+    };
+
+    struct SpaceInfo
+    {
+        const char* id;
+        Space space;
+        bool canRead;
+    };
+
+    constexpr SpaceInfo spaceInfos[] =
+    {
+        { "hex",    Space::hex,     true },
+        { "rgb",    Space::rgb,     true },
+        { "rgb8",   Space::rgb8,    true },
+        { "hsb",    Space::hsb,     true },
+        { "oklab",  Space::oklab,   true },
+        { "lab",    Space::lab,     false },
+        { "linear", Space::linear,  true },
+        { "p3",     Space::p3,      true },
+        { "name",   Space::name,    false },
+    };
+
+    std::optional<Space> findSpace (const juce::String& id, bool forReading)
+    {
+        for (auto& info : spaceInfos)
+            if (id.equalsIgnoreCase (info.id) && (info.canRead || ! forReading))
+                return info.space;
+
+        return {};
+    }
+
+    enum class Format
+    {
+        csv,
+        json
+    };
+
+    struct Options
+    {
+        Space from = Space::hex;
+        Space to = Space::rgb;
+        Format format = Format::csv;
+        int batchSize = 8192;
+    };
+
+    //==============================================================================
+    /** Lines of input, stored in one buffer so that a batch that is reused doesn't allocate. */
+    struct Batch
+    {
+        std::string text;
+        std::vector<size_t> lineEnds;
+        juce::int64 firstLine = 0;
+
+        std::string output;
+        std::string errors;
+        int numRecords = 0;
+        int numInvalid = 0;
+        int numSkipped = 0;
+
+        void clear()
+        {
+            text.clear();
+            lineEnds.clear();
+            output.clear();
+            errors.clear();
+            numRecords = 0;
+            numInvalid = 0;
+            numSkipped = 0;
+        }
+
+        std::string_view getLine (size_t index) const
+        {
+            auto start = index == 0 ? 0 : lineEnds[index - 1];
+            return std::string_view (text).substr (start, lineEnds[index] - start);
+        }
+    };
+
+    /** The batches that are read, converted and written together. */
+    struct Block
+    {
+        std::vector<Batch> batches;
+        size_t bytesRead = 0;
+        bool last = false;
+    };
+
+    /** A queue that waits for an item. It is bounded by the number of blocks that exist. */
+    template <typename T>
+    class BlockingQueue
+    {
+    public:
+        void push (T item)
+        {
+            {
+                const std::lock_guard<std::mutex> lock (mutex);
+                items.push_back (std::move (item));
+            }
+
+            available.notify_one();
+        }
+
+        T pop()
+        {
+            std::unique_lock<std::mutex> lock (mutex);
+            available.wait (lock, [this] { return ! items.empty(); });
+
+            auto item = std::move (items.front());
+            items.pop_front();
+            return item;
+        }
+
+    private:
+        std::mutex mutex;
+        std::condition_variable available;
+        std::deque<T> items;
+    };
+
+    //==============================================================================
+    /** Removes the spaces, brackets, quotes and commas around a record. */
+    std::string_view trimRecord (std::string_view line)
+    {
+        auto isPunctuation = [] (char c)
+        {
+            return c == ' ' || c == '\t' || c == '\r' || c == ',' || c == '"' || c == '\''
+                || c == '[' || c == ']' || c == '{' || c == '}';
+        };
+
+        while (! line.empty() && isPunctuation (line.front()))
+            line.remove_prefix (1);
+
+        while (! line.empty() && isPunctuation (line.back()))
+            line.remove_suffix (1);
+
+        return line;
+    }
+
+    /** Reads three or four numbers separated by commas or spaces. Returns how many were read. */
+    int parseNumbers (std::string_view record, float (&values)[4])
+    {
+        char buffer[256];
+
+        if (record.size() >= sizeof (buffer))
+            return 0;
+
+        std::copy (record.begin(), record.end(), buffer);
+        buffer[record.size()] = 0;
+
+        auto* p = buffer;
+        int num = 0;
+
+        for (;;)
+        {
+            while (*p == ' ' || *p == '\t' || *p == ',')
+                ++p;
+
+            if (*p == 0)
+                return num;
+
+            if (num == 4)
+                return 0;
+
+            char* end = nullptr;
+            values[num++] = std::strtof (p, &end);
+
+            if (end == p)
+                return 0;
+
+            p = end;
+        }
+    }
+
+    /** Reads #RGB, #RGBA, #RRGGBB or #RRGGBBAA, with or without the #, or a CSS colour name. */
+    std::optional<reFX::DeepColour> parseHex (std::string_view record)
+    {
+        auto digits = record.substr (record.size() > 0 && record[0] == '#' ? 1 : 0);
+        juce::uint32 value = 0;
+        bool isHex = ! digits.empty();
+
+        for (auto c : digits)
+        {
+            auto digit = juce::CharacterFunctions::getHexDigitValue ((juce::juce_wchar) c);
+            isHex = isHex && digit >= 0;
+            value = (value << 4) | juce::uint32 (juce::jmax (0, digit));
+        }
+
+        if (isHex)
+        {
+            auto expand = [] (juce::uint32 v, int numNibbles)
+            {
+                juce::uint32 result = 0;
+
+                for (int i = numNibbles; --i >= 0;)
+                {
+                    auto nibble = (v >> (i * 4)) & 0xf;
+                    result = (result << 8) | (nibble << 4) | nibble;
+                }
+
+                return result;
+            };
+
+            // the alpha comes last, as in CSS
+            switch (digits.size())
+            {
+                case 3:  return reFX::DeepColour (0xff000000 | expand (value, 3));
+                case 4:  return reFX::DeepColour ((expand (value, 4) >> 8) | (expand (value, 4) << 24));
+                case 6:  return reFX::DeepColour (0xff000000 | value);
+                case 8:  return reFX::DeepColour ((value >> 8) | (value << 24));
+                default: break;
+            }
+        }
+
+        if (auto named = reFX::NamedColours::find (juce::String (record.data(), record.size())))
+            return reFX::DeepColour (*named);
+
+        return {};
+    }
+
+    std::optional<reFX::DeepColour> parseRecord (std::string_view record, Space space)
+    {
+        if (space == Space::hex)
+            return parseHex (record);
+
+        float v[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+        auto num = parseNumbers (record, v);
+
+        if (num < 3)
+            return {};
+
+        switch (space)
+        {
+            case Space::rgb:    return reFX::DeepColour::fromRGBA (v[0], v[1], v[2], v[3]);
+            case Space::rgb8:   return reFX::DeepColour::fromRGBA (v[0] / 255.0f, v[1] / 255.0f, v[2] / 255.0f, num == 4 ? v[3] / 255.0f : 1.0f);
+            case Space::hsb:    return reFX::DeepColour::fromHSB (v[0], v[1], v[2], v[3]);
+            case Space::oklab:  return reFX::DeepColour::fromOKLab ({ v[0], v[1], v[2] }, v[3]);
+            case Space::linear: return reFX::DeepColour::fromRGB ({ v[0], v[1], v[2] }, reFX::WorkingSpace::linearSRGB, v[3]);
+            case Space::p3:     return reFX::DeepColour::fromRGB ({ v[0], v[1], v[2] }, reFX::WorkingSpace::displayP3, v[3]);
+            case Space::hex:
+            case Space::lab:
+            case Space::name:
+            default:            break;
+        }
+
+        return {};
+    }
+
+    //==============================================================================
+    /** Writes three numbers, and optionally the alpha. */
+    void appendNumbers (std::string& out, Format format, float x, float y, float z, float alpha, bool withAlpha)
+    {
+        auto json = format == Format::json;
+        char buffer[32];
+
+        auto append = [&] (float value, bool first)
+        {
+            if (! first)
+                out += json ? ", " : ",";
+
+            std::snprintf (buffer, sizeof (buffer), "%.6g", (double) value);
+            out += buffer;
+        };
+
+        if (json)
+            out += '[';
+
+        append (x, true);
+        append (y, false);
+        append (z, false);
+
+        if (withAlpha)
+            append (alpha, false);
+
+        if (json)
+            out += ']';
+    }
+
+    void appendText (std::string& out, Format format, const char* text)
+    {
+        if (format == Format::json)
+            out += '"';
+
+        out += text;
+
+        if (format == Format::json)
+            out += '"';
+    }
+
+    void appendColour (std::string& out, const reFX::DeepColour& colour, const Options& options)
+    {
+        // the alpha is only written for colours that aren't opaque
+        auto alpha = colour.getAlpha();
+        auto withAlpha = alpha < 1.0f;
+
+        switch (options.to)
+        {
+            case Space::hex:
+            {
+                auto c = colour.getColour();
+                char buffer[16];
+
+                if (withAlpha)
+                    std::snprintf (buffer, sizeof (buffer), "#%02X%02X%02X%02X", c.getRed(), c.getGreen(), c.getBlue(), c.getAlpha());
+                else
+                    std::snprintf (buffer, sizeof (buffer), "#%02X%02X%02X", c.getRed(), c.getGreen(), c.getBlue());
+
+                appendText (out, options.format, buffer);
+                break;
+            }
+
+            case Space::rgb:
+            {
+                auto rgb = colour.getRGB();
+                appendNumbers (out, options.format, rgb.r, rgb.g, rgb.b, alpha, withAlpha);
+                break;
+            }
+
+            case Space::rgb8:
+            {
+                auto c = colour.getColour();
+                appendNumbers (out, options.format, c.getRed(), c.getGreen(), c.getBlue(), (float) c.getAlpha(), withAlpha);
+                break;
+            }
+
+            case Space::hsb:
+            {
+                auto hsb = colour.getHSB();
+                appendNumbers (out, options.format, hsb.h, hsb.s, hsb.b, alpha, withAlpha);
+                break;
+            }
+
+            case Space::oklab:
+            {
+                auto lab = colour.getOKLab();
+                appendNumbers (out, options.format, lab.L, lab.a, lab.b, alpha, withAlpha);
+                break;
+            }
+
+            case Space::lab:
+            {
+                auto lab = colour.getLab();
+                appendNumbers (out, options.format, lab.L, lab.a, lab.b, alpha, withAlpha);
+                break;
+            }
+
+            case Space::linear:
+            case Space::p3:
+            {
+                auto rgb = colour.getRGB (options.to == Space::linear ? reFX::WorkingSpace::linearSRGB : reFX::WorkingSpace::displayP3);
+                appendNumbers (out, options.format, rgb.r, rgb.g, rgb.b, alpha, withAlpha);
+                break;
+            }
+
+            case Space::name:
+            default:
+                appendText (out, options.format, reFX::NamedColours::findNearest (colour).name.toRawUTF8());
+                break;
+        }
+    }
+
+    /** Returns true for a line that holds the structure of a JSON or CSV file
+        rather than a colour: a JSON key, or a header on the first line.
+    */
+    bool isStructure (std::string_view record, bool isFirstRecord)
+    {
+        return record.find (':') != std::string_view::npos || isFirstRecord;
+    }
+
+    /** Converts the records of a batch. Each one gets a row in the output, which is
+        empty, or null in JSON, if the record can't be read.
+    */
+    void convertBatch (Batch& batch, const Options& options)
+    {
+        auto separator = options.format == Format::json ? ",\n  " : "\n";
+
+        for (size_t i = 0; i < batch.lineEnds.size(); ++i)
+        {
+            auto record = trimRecord (batch.getLine (i));
+
+            if (record.empty())
+                continue;
+
+            auto colour = parseRecord (record, options.from);
+
+            if (! colour && isStructure (record, batch.firstLine == 0 && batch.numRecords == 0 && batch.numSkipped == 0))
+            {
+                ++batch.numSkipped;
+                continue;
+            }
+
+            if (batch.numRecords++ > 0)
+                batch.output += separator;
+
+            if (colour)
+            {
+                appendColour (batch.output, *colour, options);
+            }
+            else
+            {
+                if (options.format == Format::json)
+                    batch.output += "null";
+
+                ++batch.numInvalid;
+                batch.errors += "line " + std::to_string (batch.firstLine + (juce::int64) i + 1) + ": can't read \""
+                              + std::string (record) + "\"\n";
+            }
+        }
+    }
+
+    //==============================================================================
+    struct Totals
+    {
+        juce::int64 records = 0;
+        juce::int64 invalid = 0;
+        juce::int64 bytes = 0;
+    };
+
+    Totals convert (std::istream& input, std::ostream& output, const Options& options)
+    {
+        juce::SharedResourcePointer<reFX::WorkerPool> workers;
+
+        // a block keeps every worker busy with two batches, and four of them let
+        // reading, converting and writing overlap
+        constexpr int numBlocks = 4;
+        const auto batchesPerBlock = workers->getNumWorkers() * 2;
+
+        std::vector<std::unique_ptr<Block>> blocks;
+        BlockingQueue<Block*> toRead, toConvert, toWrite;
+
+        for (int i = 0; i < numBlocks; ++i)
+        {
+            blocks.push_back (std::make_unique<Block>());
+            blocks.back()->batches.resize ((size_t) batchesPerBlock);
+            toRead.push (blocks.back().get());
+        }
+
+        std::thread reader ([&]
+        {
+            std::string line;
+            juce::int64 lineNumber = 0;
+
+            for (;;)
+            {
+                auto* block = toRead.pop();
+                block->bytesRead = 0;
+
+                for (auto& batch : block->batches)
+                {
+                    batch.clear();
+                    batch.firstLine = lineNumber;
+
+                    while ((int) batch.lineEnds.size() < options.batchSize && std::getline (input, line))
+                    {
+                        batch.text += line;
+                        batch.lineEnds.push_back (batch.text.size());
+                        block->bytesRead += line.size() + 1;
+                        ++lineNumber;
+                    }
+                }
+
+                // once pushed, the block belongs to the other threads
+                auto last = ! input;
+                block->last = last;
+                toConvert.push (block);
+
+                if (last)
+                    return;
+            }
+        });
+
+        Totals totals;
+
+        std::thread writer ([&]
+        {
+            bool first = true;
+
+            if (options.format == Format::json)
+                output << "[\n  ";
+
+            for (;;)
+            {
+                auto* block = toWrite.pop();
+
+                for (auto& batch : block->batches)
+                {
+                    if (batch.numRecords > 0)
+                    {
+                        if (! first)
+                            output << (options.format == Format::json ? ",\n  " : "\n");
+
+                        output << batch.output;
+                        first = false;
+                    }
+
+                    std::cerr << batch.errors;
+
+                    totals.records += batch.numRecords;
+                    totals.invalid += batch.numInvalid;
+                }
+
+                totals.bytes += (juce::int64) block->bytesRead;
+
+                if (block->last)
+                    break;
+
+                toRead.push (block);
+            }
+
+            output << (options.format == Format::json ? "\n]\n" : "\n");
+            output.flush();
+        });
+
+        for (;;)
+        {
+            auto* block = toConvert.pop();
+
+            workers->parallelFor ((int) block->batches.size(), 1, [&] (int begin, int end)
+            {
+                for (int i = begin; i < end; ++i)
+                    convertBatch (block->batches[(size_t) i], options);
+            });
+
+            // the writer can hand the block back to the reader before this reads it
+            auto last = block->last;
+            toWrite.push (block);
+
+            if (last)
+                break;
+        }
+
+        reader.join();
+        writer.join();
+
+        return totals;
+    }
+
+    void printUsage()
+    {
+        std::cerr << "Converts colour tables with the reFX DeepColour code.\n\n"
+                     "ColourConvert --from <space> --to <space> [options]\n\n"
+                     "Spaces:\n"
+                     "  hex      #RGB, #RGBA, #RRGGBB or #RRGGBBAA, or a CSS colour name\n"
+                     "  rgb      sRGB, 0 to 1\n"
+                     "  rgb8     sRGB, 0 to 255\n"
+                     "  hsb      hue, saturation and brightness, 0 to 1\n"
+                     "  oklab    OKLab\n"
+                     "  lab      CIE L*a*b* (output only)\n"
+                     "  linear   linear light sRGB\n"
+                     "  p3       Display P3\n"
+                     "  name     the nearest CSS colour name (output only)\n\n"
+                     "Options:\n"
+                     "  --format csv|json   how to write the output (csv)\n"
+                     "  --batch <n>         records converted together on one thread (8192)\n"
+                     "  --input <file>      read from a file instead of stdin\n"
+                     "  --output <file>     write to a file instead of stdout\n"
+                     "  --quiet             don't report the throughput\n";
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ArgumentList args (argc, argv);
+
+    if (args.size() == 0 || args.containsOption ("--help|-h"))
+    {
+        printUsage();
+        return 0;
+    }
+
+    Options options;
+
+    auto from = findSpace (args.getValueForOption ("--from"), true);
+    auto to = findSpace (args.getValueForOption ("--to"), false);
+
+    if (! from || ! to)
+    {
+        std::cerr << "Both --from and --to need a space that can be read or written.\n\n";
+        printUsage();
+        return 1;
+    }
+
+    options.from = *from;
+    options.to = *to;
+    options.format = args.getValueForOption ("--format").equalsIgnoreCase ("json") ? Format::json : Format::csv;
+
+    if (args.containsOption ("--batch"))
+        options.batchSize = juce::jmax (1, args.getValueForOption ("--batch").getIntValue());
+
+    std::ios::sync_with_stdio (false);
+
+    std::ifstream inputFile;
+    std::ofstream outputFile;
+
+    if (args.containsOption ("--input"))
+    {
+        inputFile.open (args.getValueForOption ("--input").toStdString(), std::ios::binary);
+
+        if (! inputFile)
+        {
+            std::cerr << "Can't open " << args.getValueForOption ("--input") << "\n";
+            return 1;
+        }
+    }
+
+    if (args.containsOption ("--output"))
+    {
+        outputFile.open (args.getValueForOption ("--output").toStdString(), std::ios::binary);
+
+        if (! outputFile)
+        {
+            std::cerr << "Can't create " << args.getValueForOption ("--output") << "\n";
+            return 1;
+        }
+    }
+
+    auto& input = inputFile.is_open() ? static_cast<std::istream&> (inputFile) : std::cin;
+    auto& output = outputFile.is_open() ? static_cast<std::ostream&> (outputFile) : std::cout;
+
+    auto start = juce::Time::getMillisecondCounterHiRes();
+    auto totals = convert (input, output, options);
+    auto seconds = (juce::Time::getMillisecondCounterHiRes() - start) / 1000.0;
+
+    if (! args.containsOption ("--quiet"))
+    {
+        juce::SharedResourcePointer<reFX::WorkerPool> workers;
+        auto safeSeconds = juce::jmax (seconds, 1.0e-6);
+
+        std::cerr << juce::String::formatted ("Converted %lld colours (%lld invalid) in %.3f s: %.0f colours/s, %.1f MB/s on %d threads\n",
+                                              (long long) totals.records, (long long) totals.invalid, seconds,
+                                              double (totals.records) / safeSeconds,
+                                              double (totals.bytes) / (1024.0 * 1024.0) / safeSeconds,
+                                              workers->getNumWorkers());
+    }
+
+    return totals.invalid > 0 ? 1 : 0;
+}
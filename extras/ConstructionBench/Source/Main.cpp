@@ -0,0 +1,184 @@
+/*
+    ConstructionBench
+
+    Times how long it takes to create ColourSelectors that are never shown, as in
+    an editor with many colour properties in hidden tabs, and how long the first
+    paint of one takes, which is when its sliders, editors and colourspace are
+    created.
+
+    Each time is given twice: lazy, as the selectors work by default, and eager,
+    with createComponents() called right after construction, as selectors worked
+    before their children were created lazily. The eager column is the baseline
+    the lazy one is compared with.
+
+        ConstructionBench [--count 1000] [--size 300x400] [--runs 5]
+*/
+
+#include <refx_colourselector/refx_colourselector.h>
+
+#include <iostream>
+
+namespace
+{
+    //==============================================================================
+    struct Options
+    {
+        int count = 1000;
+        juce::Point<int> size { 300, 400 };
+        int runs = 5;
+    };
+
+    struct Layout
+    {
+        const char* name;
+        int flags;
+    };
+
+    const Layout layouts[] = {
+        { "default",  reFX::ColourSelector::showAlphaChannel | reFX::ColourSelector::showColourAtTop
+                        | reFX::ColourSelector::showRGBSliders | reFX::ColourSelector::showColourspace },
+        { "full",     reFX::ColourSelector::showAlphaChannel | reFX::ColourSelector::showColourAtTop
+                        | reFX::ColourSelector::editableColour | reFX::ColourSelector::showRGBSliders
+                        | reFX::ColourSelector::showHSBSliders | reFX::ColourSelector::showToggle
+                        | reFX::ColourSelector::showColourspace | reFX::ColourSelector::showHexEdit },
+        { "wheel",    reFX::ColourSelector::showColourAtTop | reFX::ColourSelector::showHSBSliders
+                        | reFX::ColourSelector::showHueWheel },
+    };
+
+    //==============================================================================
+    enum class Creation
+    {
+        lazy,
+        eager
+    };
+
+    std::unique_ptr<reFX::ColourSelector> createSelector (const Layout& layout, const Options& options, Creation creation)
+    {
+        auto selector = std::make_unique<reFX::ColourSelector> (layout.flags);
+
+        if (creation == Creation::eager)
+            selector->createComponents();
+
+        selector->setSize (options.size.x, options.size.y);
+        return selector;
+    }
+
+    /** Returns the best time of several runs, in microseconds per selector, to
+        create and lay out a number of hidden selectors, and to delete them again.
+    */
+    double timeHidden (const Layout& layout, const Options& options, Creation creation)
+    {
+        auto best = std::numeric_limits<double>::max();
+
+        for (int run = 0; run < options.runs; ++run)
+        {
+            std::vector<std::unique_ptr<reFX::ColourSelector>> selectors;
+            selectors.reserve ((size_t) options.count);
+
+            auto start = juce::Time::getMillisecondCounterHiRes();
+
+            for (int i = 0; i < options.count; ++i)
+                selectors.push_back (createSelector (layout, options, creation));
+
+            selectors.clear();
+
+            best = juce::jmin (best, juce::Time::getMillisecondCounterHiRes() - start);
+        }
+
+        return best * 1000.0 / options.count;
+    }
+
+    /** Returns the best time of several runs, in microseconds, to paint a new selector
+        for the first time, without the images its colourspace renders in the background.
+    */
+    double timeFirstPaint (const Layout& layout, const Options& options, Creation creation)
+    {
+        auto best = std::numeric_limits<double>::max();
+
+        for (int run = 0; run < options.runs; ++run)
+        {
+            auto selector = createSelector (layout, options, creation);
+
+            auto start = juce::Time::getMillisecondCounterHiRes();
+            selector->createComponentSnapshot (selector->getLocalBounds());
+
+            best = juce::jmin (best, juce::Time::getMillisecondCounterHiRes() - start);
+        }
+
+        return best * 1000.0;
+    }
+
+    std::optional<juce::Point<int>> parseSize (const juce::String& text)
+    {
+        auto w = text.upToFirstOccurrenceOf ("x", false, true).getIntValue();
+        auto h = text.fromFirstOccurrenceOf ("x", false, true).getIntValue();
+
+        if (w <= 0 || h <= 0)
+            return {};
+
+        return juce::Point<int> (w, h);
+    }
+
+    void printUsage()
+    {
+        std::cerr << "Times the construction of hidden reFX ColourSelectors and their first paint,\n"
+                     "with their children created lazily and eagerly.\n\n"
+                     "ConstructionBench [options]\n\n"
+                     "Options:\n"
+                     "  --count <n>      the number of selectors created in each run (1000)\n"
+                     "  --size <w>x<h>   the size of the selectors (300x400)\n"
+                     "  --runs <n>       the number of runs, of which the best counts (5)\n";
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI initialiser;
+    juce::ArgumentList args (argc, argv);
+
+    if (args.containsOption ("--help|-h"))
+    {
+        printUsage();
+        return 0;
+    }
+
+    Options options;
+
+    if (args.containsOption ("--count"))
+        options.count = juce::jmax (1, args.getValueForOption ("--count").getIntValue());
+
+    if (args.containsOption ("--size"))
+    {
+        auto size = parseSize (args.getValueForOption ("--size"));
+
+        if (! size)
+        {
+            std::cerr << "The size must be written as <width>x<height>.\n";
+            return 1;
+        }
+
+        options.size = *size;
+    }
+
+    if (args.containsOption ("--runs"))
+        options.runs = juce::jmax (1, args.getValueForOption ("--runs").getIntValue());
+
+    std::cout << "              hidden us               first paint us\n"
+                 "layout         lazy     eager  ratio      lazy     eager\n";
+
+    for (auto& layout : layouts)
+    {
+        auto lazyHidden  = timeHidden (layout, options, Creation::lazy);
+        auto eagerHidden = timeHidden (layout, options, Creation::eager);
+
+        std::cout << juce::String (layout.name).paddedRight (' ', 10)
+                  << juce::String (lazyHidden, 2).paddedLeft (' ', 9)
+                  << juce::String (eagerHidden, 2).paddedLeft (' ', 10)
+                  << juce::String (eagerHidden / juce::jmax (lazyHidden, 0.01), 1).paddedLeft (' ', 7)
+                  << juce::String (timeFirstPaint (layout, options, Creation::lazy), 1).paddedLeft (' ', 10)
+                  << juce::String (timeFirstPaint (layout, options, Creation::eager), 1).paddedLeft (' ', 10) << "\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,255 @@
+/*
+    DragReplay
+
+    Plays drag traces recorded with DragTrace::Recorder into a ColourSelector that
+    isn't on screen, and reports how long the selector took to show the result of
+    each event, and how much work it did.
+
+    Each event is sent when it is due, as recorded, or as soon as the previous one
+    is done with --speed 0. After each one the selector is painted into an image, as
+    a screen refresh would, and the background renders it asked for are waited for
+    and painted too. The time from sending the event until then is its latency.
+
+        DragReplay trace.rfxt [more.rfxt ...] [--size 400x300] [--scale 2]
+                   [--speed 1] [--repeat 1]
+*/
+
+#include <refx_colourselector/refx_colourselector.h>
+
+#include <iostream>
+
+namespace
+{
+    //==============================================================================
+    struct Options
+    {
+        std::optional<juce::Point<int>> size;
+        float scale = 1.0f;
+        double speed = 1.0;
+        int repeat = 1;
+    };
+
+    struct Results
+    {
+        std::vector<double> latencies;
+        reFX::ColourSelector::UpdateStats stats;
+        int numSkipped = 0;
+        double seconds = 0.0;
+    };
+
+    //==============================================================================
+    void runMessageLoop (int milliseconds)
+    {
+        juce::MessageManager::getInstance()->runDispatchLoopUntil (milliseconds);
+    }
+
+    /** Paints the whole selector, as a screen refresh would. */
+    void paint (reFX::ColourSelector& selector, float scale)
+    {
+        selector.createComponentSnapshot (selector.getLocalBounds(), true, scale);
+    }
+
+    /** Waits until the images the selector asked for have been delivered, and paints them. */
+    void waitForRenders (reFX::ColourSelector& selector, float scale)
+    {
+        juce::SharedResourcePointer<reFX::RenderScheduler> scheduler;
+
+        if (scheduler->getNumJobs() == 0)
+            return;
+
+        while (scheduler->getNumJobs() > 0)
+            runMessageLoop (1);
+
+        paint (selector, scale);
+    }
+
+    void addStats (reFX::ColourSelector::UpdateStats& total, const reFX::ColourSelector::UpdateStats& stats)
+    {
+        total.refreshed += stats.refreshed;
+        total.skipped += stats.skipped;
+        total.updates += stats.updates;
+        total.renders += stats.renders;
+    }
+
+    void play (const reFX::DragTrace& trace, juce::Point<int> size, const Options& options, Results& results)
+    {
+        reFX::ColourSelector selector (trace.flags);
+        selector.setSize (size.x, size.y);
+
+        reFX::DragTrace::Player player (selector, trace);
+
+        // the first images are rendered at full quality before the trace starts, as
+        // they would have been when the selector was shown
+        paint (selector, options.scale);
+        waitForRenders (selector, options.scale);
+        selector.resetUpdateStats();
+
+        auto start = juce::Time::getMillisecondCounterHiRes();
+
+        for (auto& e : trace.events)
+        {
+            if (options.speed > 0.0)
+            {
+                auto due = start + (double) e.time / options.speed;
+
+                for (auto now = juce::Time::getMillisecondCounterHiRes(); now < due; now = juce::Time::getMillisecondCounterHiRes())
+                    runMessageLoop (juce::jmax (1, (int) (due - now)));
+            }
+
+            auto sent = juce::Time::getMillisecondCounterHiRes();
+
+            if (! player.play (e))
+            {
+                ++results.numSkipped;
+                continue;
+            }
+
+            paint (selector, options.scale);
+            waitForRenders (selector, options.scale);
+
+            results.latencies.push_back (juce::Time::getMillisecondCounterHiRes() - sent);
+        }
+
+        // the images rendered at a reduced quality during the drags are replaced once the input is idle
+        runMessageLoop (selector.getRenderQuality().idleMs + 50);
+        waitForRenders (selector, options.scale);
+
+        results.seconds += (juce::Time::getMillisecondCounterHiRes() - start) / 1000.0;
+        addStats (results.stats, selector.getUpdateStats());
+    }
+
+    /** Returns the value below which a fraction of the sorted values fall. */
+    double getPercentile (const std::vector<double>& sorted, double fraction)
+    {
+        if (sorted.empty())
+            return 0.0;
+
+        auto rank = (int) std::ceil (fraction * (double) sorted.size()) - 1;
+        return sorted[(size_t) juce::jlimit (0, (int) sorted.size() - 1, rank)];
+    }
+
+    void report (const juce::String& name, Results& results)
+    {
+        std::sort (results.latencies.begin(), results.latencies.end());
+
+        auto& l = results.latencies;
+        auto& s = results.stats;
+
+        std::cout << name << ": " << l.size() << " events in " << juce::String (results.seconds, 2) << " s";
+
+        if (results.numSkipped > 0)
+            std::cout << ", " << results.numSkipped << " skipped for components the selector doesn't have";
+
+        std::cout << "\n  latency ms:  p50 " << juce::String (getPercentile (l, 0.5), 2)
+                  << "  p90 " << juce::String (getPercentile (l, 0.9), 2)
+                  << "  p99 " << juce::String (getPercentile (l, 0.99), 2)
+                  << "  max " << juce::String (l.empty() ? 0.0 : l.back(), 2)
+                  << "\n  update(): " << s.updates
+                  << "  widgets refreshed: " << s.refreshed << ", skipped: " << s.skipped
+                  << "  renders: " << s.renders << "\n";
+    }
+
+    std::optional<juce::Point<int>> parseSize (const juce::String& text)
+    {
+        auto w = text.upToFirstOccurrenceOf ("x", false, true).getIntValue();
+        auto h = text.fromFirstOccurrenceOf ("x", false, true).getIntValue();
+
+        if (w <= 0 || h <= 0)
+            return {};
+
+        return juce::Point<int> (w, h);
+    }
+
+    void printUsage()
+    {
+        std::cerr << "Plays drag traces into an offscreen reFX ColourSelector, and reports its latency.\n\n"
+                     "DragReplay <trace> [<trace> ...] [options]\n\n"
+                     "Options:\n"
+                     "  --size <w>x<h>   the size of the selector (the size it was recorded at)\n"
+                     "  --scale <s>      the display scale to paint at (1)\n"
+                     "  --speed <f>      how fast to play the events, or 0 to send each as soon as\n"
+                     "                   the previous one is done (1)\n"
+                     "  --repeat <n>     how often to play each trace (1)\n";
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI initialiser;
+    juce::ArgumentList args (argc, argv);
+
+    if (args.size() == 0 || args.containsOption ("--help|-h"))
+    {
+        printUsage();
+        return 0;
+    }
+
+    Options options;
+
+    if (args.containsOption ("--size"))
+    {
+        options.size = parseSize (args.getValueForOption ("--size"));
+
+        if (! options.size)
+        {
+            std::cerr << "The size must be written as <width>x<height>.\n";
+            return 1;
+        }
+    }
+
+    if (args.containsOption ("--scale"))
+        options.scale = juce::jmax (0.25f, args.getValueForOption ("--scale").getFloatValue());
+
+    if (args.containsOption ("--speed"))
+        options.speed = juce::jmax (0.0, args.getValueForOption ("--speed").getDoubleValue());
+
+    if (args.containsOption ("--repeat"))
+        options.repeat = juce::jmax (1, args.getValueForOption ("--repeat").getIntValue());
+
+    auto result = 0;
+
+    for (int i = 0; i < args.size(); ++i)
+    {
+        auto& arg = args[i];
+
+        if (arg.isOption())
+        {
+            // the value of an option can follow it, rather than being joined with a =
+            if (arg == "--size|--scale|--speed|--repeat" && ! arg.text.containsChar ('='))
+                ++i;
+
+            continue;
+        }
+
+        auto file = arg.resolveAsFile();
+        juce::FileInputStream input (file);
+
+        auto trace = input.openedOk() ? reFX::DragTrace::readFrom (input) : std::nullopt;
+
+        if (! trace)
+        {
+            std::cerr << "Can't read a trace from " << file.getFullPathName() << "\n";
+            result = 1;
+            continue;
+        }
+
+        auto size = options.size.value_or (trace->size);
+
+        if (size.x <= 0 || size.y <= 0)
+        {
+            std::cerr << file.getFileName() << " was recorded before the selector had a size, so it needs --size\n";
+            result = 1;
+            continue;
+        }
+
+        Results results;
+
+        for (int n = 0; n < options.repeat; ++n)
+            play (*trace, size, options, results);
+
+        report (file.getFileName(), results);
+    }
+
+    return result;
+}
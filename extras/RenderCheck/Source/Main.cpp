@@ -0,0 +1,282 @@
+/*
+    RenderCheck
+
+    Renders the colour plane and strip for every active parameter that a
+    ColourSelector offers, at fixed sizes and in each working space that changes
+    them, and compares each image with a stored golden image. Each render is also
+    timed against a budget for its case, so both a change in what the rendering
+    code draws and a slowdown make the check fail.
+
+    The exit code is 0 if every case matched its golden image within the tolerance
+    and stayed within its budget, so the check runs as a CTest test. The test
+    passes RENDERCHECK_BUDGET_SCALE as --budget-scale, which is 1 by default, so
+    a slower or shared machine, such as a CI runner, can allow more time without
+    touching the budgets here.
+
+    The golden images must come from this program, so they are created by running
+    it with --update on a real build and committing the images it writes. Until
+    there are any, the images aren't compared, and if every case stayed within
+    its budget the exit code is 77, which the test reports as skipped.
+
+        RenderCheck [--golden <dir>] [--update] [--tolerance 2] [--budget-scale 1]
+                    [--runs 5]
+*/
+
+#include <refx_colourselector/refx_colourselector.h>
+
+#include <iostream>
+
+namespace
+{
+    using Params = reFX::ColourSelector::Params;
+
+    // the exit code CTest reports as a skipped test, as set in CMakeLists.txt
+    constexpr int skippedExitCode = 77;
+
+    //==============================================================================
+    struct Options
+    {
+        juce::File goldenDir;
+        bool update = false;
+        int tolerance = 2;
+        double budgetScale = 1.0;
+        int runs = 5;
+        bool compare = true;
+    };
+
+    struct Case
+    {
+        bool plane = true;
+        Params param = Params::hue;
+        reFX::WorkingSpace space = reFX::WorkingSpace::sRGB;
+        juce::Point<int> size;
+        double budgetMs = 0.0;
+
+        juce::String getName() const
+        {
+            const char* params[] = { "hue", "saturation", "brightness", "red", "green", "blue" };
+            const char* spaces[] = { "srgb", "linear", "p3" };
+
+            return juce::String (plane ? "plane-" : "strip-") + params[(int) param] + "-" + spaces[(int) space]
+                 + "-" + juce::String (size.x) + "x" + juce::String (size.y);
+        }
+
+        juce::Image render() const
+        {
+            // a colour away from the corners of the gamut, so no axis is degenerate
+            auto colour = reFX::DeepColour::fromRGBA (0.8f, 0.35f, 0.2f, 1.0f);
+
+            return plane ? reFX::ColourSelector::renderPlane (size, colour, param, space)
+                         : reFX::ColourSelector::renderStrip (size, colour, param, space);
+        }
+    };
+
+    /** Returns the cases: each active parameter, each working space its red, green and
+        blue axes depend on, a typical size and an odd one, for the plane and the strip.
+    */
+    std::vector<Case> getCases()
+    {
+        // the best of several runs is compared against the budgets. They are about
+        // three times what a typical desktop machine takes, where the slowest cases,
+        // the hue plane and the Display P3 planes, take up to 4 ms at 256x256.
+        struct Size { bool plane; juce::Point<int> size; double hsbMs, rgbMs; };
+
+        const Size sizes[] = { { true,  { 256, 256 }, 12.0, 12.0 },
+                               { true,  { 97, 61 },   1.5,  1.5 },
+                               { false, { 24, 256 },  0.5,  0.5 },
+                               { false, { 11, 97 },   0.2,  0.2 } };
+
+        std::vector<Case> cases;
+
+        for (auto& s : sizes)
+        {
+            for (auto param : { Params::hue, Params::saturation, Params::brightness, Params::red, Params::green, Params::blue })
+            {
+                auto isRGB = param == Params::red || param == Params::green || param == Params::blue;
+
+                for (auto space : { reFX::WorkingSpace::sRGB, reFX::WorkingSpace::linearSRGB, reFX::WorkingSpace::displayP3 })
+                {
+                    // hue, saturation and brightness are always sRGB
+                    if (! isRGB && space != reFX::WorkingSpace::sRGB)
+                        continue;
+
+                    cases.push_back ({ s.plane, param, space, s.size, isRGB ? s.rgbMs : s.hsbMs });
+                }
+            }
+        }
+
+        return cases;
+    }
+
+    //==============================================================================
+    /** Returns the largest difference of any channel of any pixel, or -1 if the sizes differ. */
+    int getMaxDifference (const juce::Image& a, const juce::Image& b)
+    {
+        if (a.getWidth() != b.getWidth() || a.getHeight() != b.getHeight())
+            return -1;
+
+        const juce::Image::BitmapData pa (a, juce::Image::BitmapData::readOnly);
+        const juce::Image::BitmapData pb (b, juce::Image::BitmapData::readOnly);
+
+        int maxDifference = 0;
+
+        for (int y = 0; y < a.getHeight(); ++y)
+        {
+            for (int x = 0; x < a.getWidth(); ++x)
+            {
+                auto ca = pa.getPixelColour (x, y);
+                auto cb = pb.getPixelColour (x, y);
+
+                maxDifference = juce::jmax (maxDifference,
+                                            std::abs ((int) ca.getRed()   - (int) cb.getRed()),
+                                            std::abs ((int) ca.getGreen() - (int) cb.getGreen()),
+                                            std::abs ((int) ca.getBlue()  - (int) cb.getBlue()));
+            }
+        }
+
+        return maxDifference;
+    }
+
+    bool writeImage (const juce::Image& image, const juce::File& file)
+    {
+        file.deleteFile();
+
+        juce::FileOutputStream output (file);
+        juce::PNGImageFormat png;
+
+        return output.openedOk() && png.writeImageToStream (image, output);
+    }
+
+    /** Renders a case, times it, and compares it with its golden image. Returns true if it passed. */
+    bool check (const Case& c, const Options& options)
+    {
+        auto image = c.render();
+
+        // the first render above has warmed up the tables, so the best of the following runs is timed
+        auto best = std::numeric_limits<double>::max();
+
+        for (int i = 0; i < options.runs; ++i)
+        {
+            auto start = juce::Time::getMillisecondCounterHiRes();
+            c.render();
+            best = juce::jmin (best, juce::Time::getMillisecondCounterHiRes() - start);
+        }
+
+        auto budget = c.budgetMs * options.budgetScale;
+        auto inBudget = best <= budget;
+        auto golden = options.goldenDir.getChildFile (c.getName() + ".png");
+
+        juce::String result;
+        auto matched = true;
+
+        if (options.update)
+        {
+            matched = writeImage (image, golden);
+            result = matched ? "written" : "can't write " + golden.getFullPathName();
+        }
+        else if (! options.compare)
+        {
+            result = "not compared, there are no golden images";
+        }
+        else if (! golden.existsAsFile())
+        {
+            matched = false;
+            result = "no golden image, run with --update to create it";
+        }
+        else
+        {
+            auto difference = getMaxDifference (image, juce::ImageFileFormat::loadFrom (golden));
+
+            matched = juce::isPositiveAndNotGreaterThan (difference, options.tolerance);
+            result = difference < 0 ? juce::String ("the size differs from the golden image")
+                                    : "max difference " + juce::String (difference);
+        }
+
+        std::cout << (matched && inBudget ? "pass  " : "FAIL  ") << c.getName().paddedRight (' ', 32)
+                  << juce::String (best, 3).paddedLeft (' ', 8) << " ms of " << juce::String (budget, 2).paddedLeft (' ', 5)
+                  << (inBudget ? "   " : " ! ") << result << "\n";
+
+        return matched && inBudget;
+    }
+
+    void printUsage()
+    {
+        std::cerr << "Checks the images the reFX ColourSelector renders against golden images and time budgets.\n\n"
+                     "RenderCheck [options]\n\n"
+                     "Options:\n"
+                     "  --golden <dir>       where the golden images are kept\n"
+                     "  --update             write the rendered images as the new golden images\n"
+                     "  --tolerance <n>      the largest difference allowed in any channel, 0 to 255 (2)\n"
+                     "  --budget-scale <f>   multiplies the time budgets, for slower machines (1)\n"
+                     "  --runs <n>           the number of timed renders of each case, of which the best counts (5)\n";
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI initialiser;
+    juce::ArgumentList args (argc, argv);
+
+    if (args.containsOption ("--help|-h"))
+    {
+        printUsage();
+        return 0;
+    }
+
+    Options options;
+
+   #ifdef RENDERCHECK_GOLDEN_DIR
+    options.goldenDir = juce::File (RENDERCHECK_GOLDEN_DIR);
+   #endif
+
+    if (args.containsOption ("--golden"))
+        options.goldenDir = juce::File::getCurrentWorkingDirectory().getChildFile (args.getValueForOption ("--golden"));
+
+    if (options.goldenDir == juce::File())
+    {
+        std::cerr << "Use --golden to say where the golden images are kept.\n";
+        return 1;
+    }
+
+    options.update = args.containsOption ("--update");
+
+    if (args.containsOption ("--tolerance"))
+        options.tolerance = juce::jlimit (0, 255, args.getValueForOption ("--tolerance").getIntValue());
+
+    if (args.containsOption ("--budget-scale"))
+        options.budgetScale = juce::jmax (0.0, args.getValueForOption ("--budget-scale").getDoubleValue());
+
+    if (args.containsOption ("--runs"))
+        options.runs = juce::jmax (1, args.getValueForOption ("--runs").getIntValue());
+
+    if (options.update && ! options.goldenDir.createDirectory())
+    {
+        std::cerr << "Can't create " << options.goldenDir.getFullPathName() << "\n";
+        return 1;
+    }
+
+    options.compare = options.update
+                       || options.goldenDir.getNumberOfChildFiles (juce::File::findFiles, "*.png") > 0;
+
+    int numFailed = 0;
+    auto cases = getCases();
+
+    for (auto& c : cases)
+        if (! check (c, options))
+            ++numFailed;
+
+    std::cout << "\n" << (int) cases.size() - numFailed << " of " << cases.size() << " cases passed\n";
+
+    if (numFailed > 0)
+        return 1;
+
+    if (! options.compare)
+    {
+        std::cout << "No golden images in " << options.goldenDir.getFullPathName()
+                  << ", so only the budgets were checked. Run with --update to create them.\n";
+        return skippedExitCode;
+    }
+
+    return 0;
+}
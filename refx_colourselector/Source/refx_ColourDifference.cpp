@@ -0,0 +1,361 @@
+namespace reFX
+{
+
+//==============================================================================
+namespace
+{
+    inline float euclideanKernel (float L1, float a1, float b1, float L2, float a2, float b2) noexcept
+    {
+        auto dL = L1 - L2;
+        auto da = a1 - a2;
+        auto db = b1 - b2;
+        return std::sqrt (dL * dL + da * da + db * db);
+    }
+
+    inline float pow7 (float x) noexcept
+    {
+        auto x2 = x * x;
+        auto x3 = x2 * x;
+        return x3 * x3 * x;
+    }
+
+    /** CIEDE2000, after Sharma, Wu and Dalal (2005), written without branches
+        so that the batch version can be vectorised. Angles are in radians.
+    */
+    inline float ciede2000Kernel (float L1, float a1, float b1, float L2, float a2, float b2) noexcept
+    {
+        constexpr auto pi = juce::MathConstants<float>::pi;
+        constexpr auto twoPi = juce::MathConstants<float>::twoPi;
+        constexpr auto deg = pi / 180.0f;
+        constexpr auto pow25To7 = 6103515625.0f;
+
+        auto C1 = std::sqrt (a1 * a1 + b1 * b1);
+        auto C2 = std::sqrt (a2 * a2 + b2 * b2);
+        auto Cbar7 = pow7 (0.5f * (C1 + C2));
+        auto G = 0.5f * (1.0f - std::sqrt (Cbar7 / (Cbar7 + pow25To7)));
+
+        auto a1p = (1.0f + G) * a1;
+        auto a2p = (1.0f + G) * a2;
+        auto C1p = std::sqrt (a1p * a1p + b1 * b1);
+        auto C2p = std::sqrt (a2p * a2p + b2 * b2);
+
+        auto h1p = std::atan2 (b1, a1p);
+        auto h2p = std::atan2 (b2, a2p);
+        h1p = h1p < 0.0f ? h1p + twoPi : h1p;
+        h2p = h2p < 0.0f ? h2p + twoPi : h2p;
+
+        auto product = C1p * C2p;
+        auto achromatic = product == 0.0f;
+
+        auto dLp = L2 - L1;
+        auto dCp = C2p - C1p;
+
+        auto dhp = h2p - h1p;
+        dhp = dhp > pi ? dhp - twoPi : (dhp < -pi ? dhp + twoPi : dhp);
+        dhp = achromatic ? 0.0f : dhp;
+
+        auto dHp = 2.0f * std::sqrt (product) * std::sin (0.5f * dhp);
+
+        auto Lbarp = 0.5f * (L1 + L2);
+        auto Cbarp = 0.5f * (C1p + C2p);
+
+        auto hsum = h1p + h2p;
+        auto hbarp = std::abs (h1p - h2p) > pi ? 0.5f * (hsum < twoPi ? hsum + twoPi : hsum - twoPi)
+                                               : 0.5f * hsum;
+        hbarp = achromatic ? hsum : hbarp;
+
+        auto T = 1.0f - 0.17f * std::cos (hbarp - 30.0f * deg)
+                      + 0.24f * std::cos (2.0f * hbarp)
+                      + 0.32f * std::cos (3.0f * hbarp + 6.0f * deg)
+                      - 0.20f * std::cos (4.0f * hbarp - 63.0f * deg);
+
+        auto hueOffset = (hbarp - 275.0f * deg) / (25.0f * deg);
+        auto dTheta = 30.0f * deg * std::exp (-hueOffset * hueOffset);
+
+        auto Cbarp7 = pow7 (Cbarp);
+        auto RC = 2.0f * std::sqrt (Cbarp7 / (Cbarp7 + pow25To7));
+
+        auto Lm50 = (Lbarp - 50.0f) * (Lbarp - 50.0f);
+        auto SL = 1.0f + 0.015f * Lm50 / std::sqrt (20.0f + Lm50);
+        auto SC = 1.0f + 0.045f * Cbarp;
+        auto SH = 1.0f + 0.015f * Cbarp * T;
+        auto RT = -std::sin (2.0f * dTheta) * RC;
+
+        auto l = dLp / SL;
+        auto c = dCp / SC;
+        auto h = dHp / SH;
+
+        return std::sqrt (juce::jmax (0.0f, l * l + c * c + h * h + RT * c * h));
+    }
+}
+
+//==============================================================================
+float ColourDifference::cie76 (const CIELab& x, const CIELab& y) noexcept
+{
+    return euclideanKernel (x.L, x.a, x.b, y.L, y.a, y.b);
+}
+
+float ColourDifference::ciede2000 (const CIELab& x, const CIELab& y) noexcept
+{
+    return ciede2000Kernel (x.L, x.a, x.b, y.L, y.a, y.b);
+}
+
+float ColourDifference::okLab (const OKLab& x, const OKLab& y) noexcept
+{
+    return euclideanKernel (x.L, x.a, x.b, y.L, y.a, y.b);
+}
+
+float ColourDifference::between (const DeepColour& x, const DeepColour& y, Metric metric) noexcept
+{
+    if (metric == Metric::cie76)
+        return cie76 (x.getLab(), y.getLab());
+    if (metric == Metric::ciede2000)
+        return ciede2000 (x.getLab(), y.getLab());
+
+    return okLab (x.getOKLab(), y.getOKLab());
+}
+
+//==============================================================================
+ColourDifference::Channels::Channels (const std::vector<DeepColour>& colours, Metric metric)
+    : L (colours.size()), a (colours.size()), b (colours.size())
+{
+    for (size_t i = 0; i < colours.size(); ++i)
+    {
+        if (metric == Metric::okLab)
+        {
+            auto lab = colours[i].getOKLab();
+            L[i] = lab.L;
+            a[i] = lab.a;
+            b[i] = lab.b;
+        }
+        else
+        {
+            auto lab = colours[i].getLab();
+            L[i] = lab.L;
+            a[i] = lab.a;
+            b[i] = lab.b;
+        }
+    }
+}
+
+void ColourDifference::batch (const DeepColour& reference, const Channels& channels, Metric metric, float* out) noexcept
+{
+    if (metric == Metric::cie76)
+        cie76 (reference.getLab(), channels.L.data(), channels.a.data(), channels.b.data(), out, channels.size());
+    else if (metric == Metric::ciede2000)
+        ciede2000 (reference.getLab(), channels.L.data(), channels.a.data(), channels.b.data(), out, channels.size());
+    else
+        okLab (reference.getOKLab(), channels.L.data(), channels.a.data(), channels.b.data(), out, channels.size());
+}
+
+void ColourDifference::cie76 (const CIELab& ref, const float* L, const float* a, const float* b, float* out, int num) noexcept
+{
+    for (int i = 0; i < num; ++i)
+        out[i] = euclideanKernel (ref.L, ref.a, ref.b, L[i], a[i], b[i]);
+}
+
+void ColourDifference::ciede2000 (const CIELab& ref, const float* L, const float* a, const float* b, float* out, int num) noexcept
+{
+    for (int i = 0; i < num; ++i)
+        out[i] = ciede2000Kernel (ref.L, ref.a, ref.b, L[i], a[i], b[i]);
+}
+
+void ColourDifference::okLab (const OKLab& ref, const float* L, const float* a, const float* b, float* out, int num) noexcept
+{
+    for (int i = 0; i < num; ++i)
+        out[i] = euclideanKernel (ref.L, ref.a, ref.b, L[i], a[i], b[i]);
+}
+
+//==============================================================================
+float ColourDifference::relativeLuminance (const DeepColour& colour) noexcept
+{
+    auto rgb = colour.getRGB();
+    return 0.2126f * srgbToLinear (rgb.r) + 0.7152f * srgbToLinear (rgb.g) + 0.0722f * srgbToLinear (rgb.b);
+}
+
+float ColourDifference::contrastRatio (const DeepColour& x, const DeepColour& y) noexcept
+{
+    auto lx = relativeLuminance (x);
+    auto ly = relativeLuminance (y);
+
+    return (juce::jmax (lx, ly) + 0.05f) / (juce::jmin (lx, ly) + 0.05f);
+}
+
+void ColourDifference::contrastRatio (float referenceLuminance, const float* r, const float* g, const float* b,
+                                      float* out, int num) noexcept
+{
+    auto ref = referenceLuminance + 0.05f;
+
+    for (int i = 0; i < num; ++i)
+    {
+        auto l = 0.2126f * r[i] + 0.7152f * g[i] + 0.0722f * b[i] + 0.05f;
+        out[i] = std::max (l, ref) / std::min (l, ref);
+    }
+}
+
+//==============================================================================
+ColourDifference::Clusters ColourDifference::deduplicate (const std::vector<DeepColour>& palette, float threshold, Metric metric)
+{
+    Clusters result;
+    result.indices.reserve (palette.size());
+
+    if (threshold <= 0.0f)
+    {
+        for (size_t i = 0; i < palette.size(); ++i)
+        {
+            result.colours.push_back (palette[i]);
+            result.counts.push_back (1);
+            result.indices.push_back (int (i));
+        }
+
+        return result;
+    }
+
+    const Channels channels (palette, metric);
+    const auto cellSize = threshold * 2.0f;
+
+    auto cellOf = [cellSize] (float v) { return int (std::floor (v / cellSize)); };
+
+    auto keyOf = [] (int x, int y, int z)
+    {
+        return (juce::int64 (x & 0x1fffff) << 42) | (juce::int64 (y & 0x1fffff) << 21) | juce::int64 (z & 0x1fffff);
+    };
+
+    // the clusters starting in each cell, and their first colours as channel arrays
+    std::unordered_map<juce::int64, std::vector<int>> grid;
+    Channels clusterChannels;
+
+    std::vector<int> candidates;
+    std::vector<float> candL, candA, candB, distances;
+
+    for (int i = 0; i < channels.size(); ++i)
+    {
+        auto L = channels.L[size_t (i)];
+        auto a = channels.a[size_t (i)];
+        auto b = channels.b[size_t (i)];
+
+        // CIEDE2000 divides the lightness and chroma differences by up to these weights,
+        // so a match can be further away than the threshold in L*a*b*. The a* stretch
+        // adds at most 6.4 to the chroma of a pair.
+        auto reach = threshold;
+
+        if (metric == Metric::ciede2000)
+        {
+            auto Lm50 = (L - 50.0f) * (L - 50.0f);
+            auto SL = 1.0f + 0.015f * Lm50 / std::sqrt (20.0f + Lm50);
+            auto SC = 1.0f + 0.045f * (std::sqrt (a * a + b * b) + threshold + 6.4f);
+            reach *= juce::jmax (SL, SC);
+        }
+
+        auto radius = int (std::ceil (reach / cellSize));
+        auto cx = cellOf (L);
+        auto cy = cellOf (a);
+        auto cz = cellOf (b);
+
+        candidates.clear();
+
+        for (int dx = -radius; dx <= radius; ++dx)
+        {
+            for (int dy = -radius; dy <= radius; ++dy)
+            {
+                for (int dz = -radius; dz <= radius; ++dz)
+                {
+                    // skip the corners of the cube that lie outside the search sphere
+                    auto gx = float (juce::jmax (0, std::abs (dx) - 1));
+                    auto gy = float (juce::jmax (0, std::abs (dy) - 1));
+                    auto gz = float (juce::jmax (0, std::abs (dz) - 1));
+
+                    if ((gx * gx + gy * gy + gz * gz) * cellSize * cellSize > reach * reach)
+                        continue;
+
+                    auto found = grid.find (keyOf (cx + dx, cy + dy, cz + dz));
+
+                    if (found != grid.end())
+                        candidates.insert (candidates.end(), found->second.begin(), found->second.end());
+                }
+            }
+        }
+
+        auto best = -1;
+
+        if (! candidates.empty())
+        {
+            auto num = candidates.size();
+            candL.resize (num);
+            candA.resize (num);
+            candB.resize (num);
+            distances.resize (num);
+
+            for (size_t j = 0; j < num; ++j)
+            {
+                auto c = size_t (candidates[j]);
+                candL[j] = clusterChannels.L[c];
+                candA[j] = clusterChannels.a[c];
+                candB[j] = clusterChannels.b[c];
+            }
+
+            if (metric == Metric::ciede2000)
+            {
+                // drop the candidates outside the search sphere before running the expensive kernel
+                cie76 ({ L, a, b }, candL.data(), candA.data(), candB.data(), distances.data(), int (num));
+
+                size_t kept = 0;
+
+                for (size_t j = 0; j < num; ++j)
+                {
+                    if (distances[j] <= reach)
+                    {
+                        candidates[kept] = candidates[j];
+                        candL[kept] = candL[j];
+                        candA[kept] = candA[j];
+                        candB[kept] = candB[j];
+                        ++kept;
+                    }
+                }
+
+                num = kept;
+                ciede2000 ({ L, a, b }, candL.data(), candA.data(), candB.data(), distances.data(), int (num));
+            }
+            else if (metric == Metric::cie76)
+            {
+                cie76 ({ L, a, b }, candL.data(), candA.data(), candB.data(), distances.data(), int (num));
+            }
+            else
+            {
+                okLab ({ L, a, b }, candL.data(), candA.data(), candB.data(), distances.data(), int (num));
+            }
+
+            auto closest = threshold;
+
+            for (size_t j = 0; j < num; ++j)
+            {
+                if (distances[j] < closest)
+                {
+                    closest = distances[j];
+                    best = candidates[j];
+                }
+            }
+        }
+
+        if (best < 0)
+        {
+            best = int (result.colours.size());
+
+            result.colours.push_back (palette[size_t (i)]);
+            result.counts.push_back (0);
+
+            clusterChannels.L.push_back (L);
+            clusterChannels.a.push_back (a);
+            clusterChannels.b.push_back (b);
+
+            grid[keyOf (cx, cy, cz)].push_back (best);
+        }
+
+        result.counts[size_t (best)]++;
+        result.indices.push_back (best);
+    }
+
+    return result;
+}
+
+} // namespace reFX
@@ -0,0 +1,98 @@
+#pragma once
+
+namespace reFX
+{
+
+//==============================================================================
+/**
+    Perceptual colour difference metrics, and a palette deduplication built on them.
+
+    The batch functions compare one reference colour against many colours stored
+    as separate channel arrays. Their loops are branch-free so that the compiler
+    can vectorise them.
+
+    @tags{Graphics}
+*/
+class ColourDifference
+{
+public:
+    //==============================================================================
+    enum class Metric
+    {
+        cie76,          /**< Euclidean distance in CIE L*a*b*. A difference of about 2.3 is just noticeable. */
+        ciede2000,      /**< The CIEDE2000 formula, in the same units as cie76. */
+        okLab,          /**< Euclidean distance in OKLab. A difference of about 0.02 is just noticeable. */
+    };
+
+    //==============================================================================
+    static float cie76 (const CIELab& x, const CIELab& y) noexcept;
+    static float ciede2000 (const CIELab& x, const CIELab& y) noexcept;
+    static float okLab (const OKLab& x, const OKLab& y) noexcept;
+
+    /** Returns the difference between two colours, ignoring their alpha. */
+    static float between (const DeepColour& x, const DeepColour& y, Metric metric) noexcept;
+
+    //==============================================================================
+    /** Colours stored as separate channel arrays, in the space used by a metric. */
+    struct Channels
+    {
+        Channels() = default;
+        Channels (const std::vector<DeepColour>& colours, Metric metric);
+
+        int size() const noexcept                       { return int (L.size()); }
+
+        std::vector<float> L, a, b;
+    };
+
+    /** Writes the difference between the reference and each colour to out,
+        which must have space for channels.size() values.
+    */
+    static void batch (const DeepColour& reference, const Channels& channels, Metric metric, float* out) noexcept;
+
+    static void cie76 (const CIELab& reference, const float* L, const float* a, const float* b, float* out, int num) noexcept;
+    static void ciede2000 (const CIELab& reference, const float* L, const float* a, const float* b, float* out, int num) noexcept;
+    static void okLab (const OKLab& reference, const float* L, const float* a, const float* b, float* out, int num) noexcept;
+
+    //==============================================================================
+    /** Returns the WCAG 2 relative luminance of a colour, ignoring its alpha. */
+    static float relativeLuminance (const DeepColour& colour) noexcept;
+
+    /** Returns the WCAG 2 contrast ratio between two colours, from 1 to 21, ignoring their alpha. */
+    static float contrastRatio (const DeepColour& x, const DeepColour& y) noexcept;
+
+    /** Writes the contrast ratio between a reference luminance and each linear light
+        colour to out.
+    */
+    static void contrastRatio (float referenceLuminance, const float* linearRed, const float* linearGreen,
+                               const float* linearBlue, float* out, int num) noexcept;
+
+    //==============================================================================
+    /** The result of deduplicate(). */
+    struct Clusters
+    {
+        /** One colour for each cluster, in the order the clusters were first seen. */
+        std::vector<DeepColour> colours;
+
+        /** The number of input colours merged into each cluster. */
+        std::vector<int> counts;
+
+        /** The cluster each input colour was merged into. */
+        std::vector<int> indices;
+    };
+
+    /** Merges colours that are closer to each other than the threshold.
+
+        Each colour joins the closest earlier cluster within the threshold, or starts a
+        new one. Clusters keep the first colour that started them, so the result keeps
+        the order of the palette.
+
+        Candidates are found through a hash grid over the metric's colour space, so the
+        cost grows with the number of colours rather than with the number of pairs. For
+        ciede2000 the search radius is scaled by the chroma weighting of the query
+        colour. The hue rotation term in the blues isn't bounded by that, so a few
+        pairs there that are just under the threshold can stay apart.
+    */
+    static Clusters deduplicate (const std::vector<DeepColour>& palette, float threshold, Metric metric);
+};
+
+} // namespace reFX
@@ -0,0 +1,117 @@
+namespace reFX
+{
+
+//==============================================================================
+namespace
+{
+    constexpr int histogramSize = ColourHistogram::numBins * ColourHistogram::numBins * ColourHistogram::numBins;
+
+    int getHistogramBin (float value) noexcept
+    {
+        return juce::jlimit (0, ColourHistogram::numBins - 1, int (value * float (ColourHistogram::numBins)));
+    }
+
+    int getHistogramIndex (int a, int b, int c) noexcept
+    {
+        return (a * ColourHistogram::numBins + b) * ColourHistogram::numBins + c;
+    }
+}
+
+//==============================================================================
+ColourHistogram::ColourHistogram (const juce::Image& image, float minAlpha)
+{
+    if (! image.isValid())
+        return;
+
+    rgbCounts.assign (histogramSize, 0);
+    hsbCounts.assign (histogramSize, 0);
+
+    juce::SharedResourcePointer<WorkerPool> workers;
+    juce::CriticalSection lock;
+
+    const juce::Image::BitmapData pixels (image, juce::Image::BitmapData::readOnly);
+    auto width = image.getWidth();
+    auto height = image.getHeight();
+    auto alphaThreshold = juce::uint8 (juce::jlimit (0, 255, juce::roundToInt (minAlpha * 255.0f)));
+
+    // a few large chunks, as each one bins into its own histograms before they are merged
+    auto chunkSize = juce::jmax (1, height / workers->getNumWorkers());
+
+    workers->parallelFor (height, chunkSize, [&] (int begin, int end)
+    {
+        std::vector<juce::uint32> rgb (histogramSize), hsb (histogramSize);
+        int count = 0;
+
+        for (int y = begin; y < end; ++y)
+        {
+            for (int x = 0; x < width; ++x)
+            {
+                auto c = pixels.getPixelColour (x, y);
+
+                if (c.getAlpha() < alphaThreshold)
+                    continue;
+
+                auto r = c.getFloatRed();
+                auto g = c.getFloatGreen();
+                auto b = c.getFloatBlue();
+                auto h = rgbToHsb (RGB (r, g, b));
+
+                ++rgb[(size_t) getHistogramIndex (getHistogramBin (r), getHistogramBin (g), getHistogramBin (b))];
+                ++hsb[(size_t) getHistogramIndex (getHistogramBin (h.h), getHistogramBin (h.s), getHistogramBin (h.b))];
+                ++count;
+            }
+        }
+
+        const juce::ScopedLock sl (lock);
+
+        for (size_t i = 0; i < (size_t) histogramSize; ++i)
+        {
+            rgbCounts[i] += rgb[i];
+            hsbCounts[i] += hsb[i];
+        }
+
+        numPixels += count;
+    });
+}
+
+//==============================================================================
+float ColourHistogram::project (Axis x, Axis y, float* out, float minimum, float maximum) const
+{
+    std::fill (out, out + numBins * numBins, 0.0f);
+
+    auto isHsb = [] (Axis a) { return a == Axis::hue || a == Axis::saturation || a == Axis::brightness; };
+
+    // both axes must be in the same space
+    jassert (isHsb (x) == isHsb (y) && x != y);
+
+    const auto& counts = isHsb (x) ? hsbCounts : rgbCounts;
+
+    if (counts.empty())
+        return 0.0f;
+
+    auto xAxis = int (x) % 3;
+    auto yAxis = int (y) % 3;
+    auto zAxis = 3 - xAxis - yAxis;
+
+    auto zStart = getHistogramBin (minimum);
+    auto zEnd   = getHistogramBin (maximum);
+
+    int index[3];
+
+    for (index[yAxis] = 0; index[yAxis] < numBins; ++index[yAxis])
+    {
+        for (index[xAxis] = 0; index[xAxis] < numBins; ++index[xAxis])
+        {
+            juce::uint32 sum = 0;
+
+            for (index[zAxis] = zStart; index[zAxis] <= zEnd; ++index[zAxis])
+                sum += counts[(size_t) getHistogramIndex (index[0], index[1], index[2])];
+
+            out[index[yAxis] * numBins + index[xAxis]] = float (sum);
+        }
+    }
+
+    return *std::max_element (out, out + numBins * numBins);
+}
+
+} // namespace reFX
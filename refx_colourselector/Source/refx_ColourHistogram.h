@@ -0,0 +1,64 @@
+#pragma once
+
+namespace reFX
+{
+
+//==============================================================================
+/**
+    Counts how the colours of an image are distributed, in RGB and in HSB.
+
+    The pixels are binned once, in parallel on the shared WorkerPool, into two 3D
+    histograms. Projecting them onto a pair of axes only visits the bins, so the
+    density of the image's colours can be shown on a colour plane, whatever its
+    axes, without looking at the pixels again.
+
+    @tags{Graphics}
+*/
+class ColourHistogram
+{
+public:
+    //==============================================================================
+    /** The axes of the histograms, in the same order as ColourSelector::Params. */
+    enum class Axis
+    {
+        hue,
+        saturation,
+        brightness,
+
+        red,
+        green,
+        blue,
+    };
+
+    /** The number of bins along each axis. */
+    static constexpr int numBins = 32;
+
+    //==============================================================================
+    /** Creates an empty histogram. */
+    ColourHistogram() = default;
+
+    /** Bins the pixels of an image that are at least as opaque as minAlpha. */
+    explicit ColourHistogram (const juce::Image& image, float minAlpha = 0.5f);
+
+    /** Returns the number of pixels that were binned. */
+    int getNumPixels() const noexcept                   { return numPixels; }
+
+    /** Sums the bins along the third axis of the space that x and y are in, into a
+        grid of numBins by numBins counts. Row y of the grid starts at out[y * numBins].
+
+        Only the bins of the third axis between minimum and maximum are added, so
+        passing a narrow range shows the slice of the colours near a value.
+
+        Returns the largest count in the grid.
+    */
+    float project (Axis x, Axis y, float* out, float minimum = 0.0f, float maximum = 1.0f) const;
+
+private:
+    //==============================================================================
+    std::vector<juce::uint32> rgbCounts, hsbCounts;
+    int numPixels = 0;
+
+    JUCE_LEAK_DETECTOR (ColourHistogram)
+};
+
+} // namespace reFX
@@ -0,0 +1,125 @@
+namespace reFX
+{
+
+//==============================================================================
+ColourModel::ColourModel()
+    : ColourModel (DeepColour (juce::Colours::white))
+{
+}
+
+ColourModel::ColourModel (const DeepColour& initialColour)
+    : colour (initialColour),
+      originalColour (initialColour),
+      hsb (initialColour.getHSB()),
+      rgb (initialColour.getRGB())
+{
+    value.addListener (this);
+}
+
+ColourModel::~ColourModel()
+{
+    // a property the Value refers to gets the last colour
+    handleUpdateNowIfNeeded();
+    value.removeListener (this);
+}
+
+//==============================================================================
+void ColourModel::setColour (const DeepColour& newColour, juce::NotificationType notification)
+{
+    store (newColour, originalColour, notification);
+}
+
+void ColourModel::setColourAndOriginal (const DeepColour& newColour, const DeepColour& newOriginal,
+                                        juce::NotificationType notification)
+{
+    store (newColour, newOriginal, notification);
+}
+
+void ColourModel::resetToOriginal (juce::NotificationType notification)
+{
+    store (originalColour, originalColour, notification);
+}
+
+void ColourModel::store (const DeepColour& newColour, const DeepColour& newOriginal, juce::NotificationType notification)
+{
+    if (newColour == colour && newOriginal == originalColour)
+        return;
+
+    colour = newColour;
+    originalColour = newOriginal;
+    hsb = colour.getHSB();
+    rgb = colour.getRGB();
+
+    // writing the string allocates, so it is left until the changes are done
+    if (valueInUse)
+        triggerAsyncUpdate();
+
+    // a listener is changing the colour from its callback. The round in progress
+    // goes on, and the listeners are called again with the latest colour afterwards.
+    if (notifying)
+    {
+        changedWhileNotifying = true;
+
+        if (notification != juce::dontSendNotification)
+            pendingNotification = notification;
+
+        return;
+    }
+
+    const juce::ScopedValueSetter<bool> svs (notifying, true);
+
+    for (int round = 0; ; ++round)
+    {
+        changedWhileNotifying = false;
+        pendingNotification = juce::dontSendNotification;
+
+        listeners.call ([this, notification] (Listener& l) { l.colourModelChanged (*this, notification); });
+
+        if (! changedWhileNotifying)
+            break;
+
+        // the listeners keep changing the colour, which is a feedback loop between them
+        if (round == 8)
+        {
+            jassertfalse;
+            break;
+        }
+
+        notification = pendingNotification;
+    }
+}
+
+//==============================================================================
+juce::Value& ColourModel::getValue()
+{
+    if (! valueInUse)
+    {
+        valueInUse = true;
+        triggerAsyncUpdate();
+    }
+
+    handleUpdateNowIfNeeded();
+    return value;
+}
+
+void ColourModel::handleAsyncUpdate()
+{
+    // our own valueChanged() callback sees the string it wrote and ignores it
+    valueText = colour.getColour().toString();
+    value = valueText;
+}
+
+void ColourModel::valueChanged (juce::Value&)
+{
+    auto text = value.toString();
+
+    // the colour may have changed again since the string was written, and the
+    // string mustn't set it back
+    if (text == valueText)
+        return;
+
+    valueText = text;
+    setColour (DeepColour (juce::Colour::fromString (text)));
+}
+
+} // namespace reFX
@@ -0,0 +1,109 @@
+#pragma once
+
+namespace reFX
+{
+
+//==============================================================================
+/**
+    A colour, and the original colour it was edited from, that several views
+    can share.
+
+    Any number of ColourSelectors and other listeners can attach to one model.
+    A change is stored and converted to HSB and RGB once, and then passed to
+    every listener once.
+
+    Listeners may change the colour from their callbacks. Such changes don't
+    start a nested round of callbacks: once the current round is finished,
+    the listeners are called again with the latest colour. If the listeners
+    keep changing the colour, this stops after a few rounds.
+
+    The colour is also available as a juce::Value holding the colour's
+    juce::Colour::toString() form, which can refer to a ValueTree property to
+    store the colour there. The string is only kept once getValue() has been
+    called, and is written on the message thread after the colour changes, so
+    the changes made during one drag or burst of messages are written once.
+
+    @tags{GUI}
+*/
+class ColourModel  : private juce::Value::Listener,
+                     private juce::AsyncUpdater
+{
+public:
+    //==============================================================================
+    /** Creates a model holding white. */
+    ColourModel();
+
+    /** Creates a model holding a colour, which is also the original colour. */
+    explicit ColourModel (const DeepColour& initialColour);
+
+    ~ColourModel() override;
+
+    //==============================================================================
+    const DeepColour& getColour() const noexcept        { return colour; }
+    const DeepColour& getOriginalColour() const noexcept { return originalColour; }
+
+    /** Returns the colour's hue, saturation and brightness, converted when the colour was set. */
+    const HSB& getHSB() const noexcept                  { return hsb; }
+
+    /** Returns the colour's red, green and blue, converted when the colour was set. */
+    const RGB& getRGB() const noexcept                  { return rgb; }
+
+    /** Changes the colour.
+
+        The listeners are always told, so their views stay in step. The
+        notification type is passed on to them, so they can decide whether to
+        tell their own listeners.
+    */
+    void setColour (const DeepColour& newColour, juce::NotificationType notification = juce::sendNotification);
+
+    /** Changes the colour and the original colour at once. */
+    void setColourAndOriginal (const DeepColour& newColour, const DeepColour& newOriginal,
+                               juce::NotificationType notification = juce::sendNotification);
+
+    /** Sets the colour back to the original colour. */
+    void resetToOriginal (juce::NotificationType notification = juce::sendNotification);
+
+    //==============================================================================
+    /** The colour as a string, which can refer to another Value to keep them in sync.
+
+        A change of the colour that hasn't been written to the Value yet is
+        written before it is returned.
+    */
+    juce::Value& getValue();
+
+    //==============================================================================
+    class Listener
+    {
+    public:
+        virtual ~Listener() = default;
+
+        /** Called when the colour or the original colour changes. */
+        virtual void colourModelChanged (ColourModel& model, juce::NotificationType notification) = 0;
+    };
+
+    void addListener (Listener* listener)               { listeners.add (listener); }
+    void removeListener (Listener* listener)            { listeners.remove (listener); }
+
+private:
+    //==============================================================================
+    DeepColour colour, originalColour;
+    HSB hsb;
+    RGB rgb;
+
+    juce::ListenerList<Listener> listeners;
+    juce::Value value;
+    juce::String valueText;
+    bool valueInUse = false;
+
+    bool notifying = false;
+    bool changedWhileNotifying = false;
+    juce::NotificationType pendingNotification = juce::dontSendNotification;
+
+    void store (const DeepColour& newColour, const DeepColour& newOriginal, juce::NotificationType);
+    void valueChanged (juce::Value&) override;
+    void handleAsyncUpdate() override;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ColourModel)
+};
+
+} // namespace reFX
@@ -2,13 +2,17 @@ namespace reFX
 {
 
 //==============================================================================
-struct ColourComponentSlider  : public juce::Slider
+class ColourSelector::ColourComponentSlider  : public juce::Slider
 {
-    ColourComponentSlider (const juce::String& name, int max)  : juce::Slider (name)
+public:
+    ColourComponentSlider (const juce::String& name, int max, Channel c)
+        : juce::Slider (name), channel (c)
     {
         setRange (0.0, double (max), 0.0);
     }
 
+    const Channel channel;
+
     juce::String getTextFromValue (double value) override
     {
         return juce::String ((int) value);
@@ -20,6 +24,178 @@ struct ColourComponentSlider  : public juce::Slider
     }
 };
 
+//==============================================================================
+/** Returns the hue, saturation and brightness or the red, green and blue
+    components of a colour, depending on which colourspace the param is in.
+    Red, green and blue are in the working space.
+*/
+static std::array<float, 3> getComponents (const DeepColour& c, ColourSelector::Params param, WorkingSpace space)
+{
+    if (param == ColourSelector::Params::hue || param == ColourSelector::Params::saturation || param == ColourSelector::Params::brightness)
+    {
+        auto hsb = c.getHSB();
+        return { hsb.h, hsb.s, hsb.b };
+    }
+
+    auto rgb = c.getRGB (space);
+    return { rgb.r, rgb.g, rgb.b };
+}
+
+/** Returns true if the param is one of the red, green and blue components. */
+static bool isRGBParam (ColourSelector::Params param)
+{
+    return param == ColourSelector::Params::red || param == ColourSelector::Params::green || param == ColourSelector::Params::blue;
+}
+
+/** Returns the index of the param within the array returned by getComponents(). */
+static int getComponentIndex (ColourSelector::Params param)
+{
+    if (param == ColourSelector::Params::hue || param == ColourSelector::Params::red)
+        return 0;
+    if (param == ColourSelector::Params::saturation || param == ColourSelector::Params::green)
+        return 1;
+
+    return 2;
+}
+
+/** Returns the size in physical pixels of an area drawn at a scale. */
+static juce::Point<int> getPhysicalSize (juce::Rectangle<int> area, float scale)
+{
+    return { juce::jmax (1, juce::roundToInt ((float) area.getWidth()  * scale)),
+             juce::jmax (1, juce::roundToInt ((float) area.getHeight() * scale)) };
+}
+
+/** Draws an image rendered at a scale into an area. If the image still has the
+    physical size of the area this is a 1:1 copy, otherwise a reduced or stale
+    image is stretched to fill it.
+*/
+static void drawPhysicalImage (juce::Graphics& g, const juce::Image& image, juce::Rectangle<int> area, float scale)
+{
+    auto size = getPhysicalSize (area, scale);
+
+    auto transform = (image.getWidth() == size.x && image.getHeight() == size.y)
+                        ? juce::AffineTransform::scale (1.0f / scale)
+                        : juce::AffineTransform::scale ((float) area.getWidth()  / (float) image.getWidth(),
+                                                        (float) area.getHeight() / (float) image.getHeight());
+
+    g.setOpacity (1.0f);
+    g.drawImageTransformed (image, transform.translated ((float) area.getX(), (float) area.getY()), false);
+}
+
+/** Draws an image like the function above, and tells the governor how long that
+    took. Stretching a reduced image is part of every frame that shows it, so the
+    governor leaves time for it when it chooses the quality.
+*/
+static void drawPhysicalImage (juce::Graphics& g, const juce::Image& image, juce::Rectangle<int> area, float scale,
+                               RenderQualityGovernor& governor)
+{
+    auto start = juce::Time::getMillisecondCounterHiRes();
+    drawPhysicalImage (g, image, area, scale);
+
+    auto size = getPhysicalSize (area, scale);
+    governor.addDrawMeasurement (size.x * size.y, juce::Time::getMillisecondCounterHiRes() - start);
+}
+
+/** The colour vision simulation of a cached image. It is only worked out again
+    when the image or the deficiency changes, so repainting or switching the
+    simulation on and off doesn't render the image again.
+*/
+struct SimulatedImage
+{
+    const juce::Image& get (const juce::Image& source, ColourVision::Deficiency deficiency, RasterPool& pool)
+    {
+        if (deficiency == ColourVision::Deficiency::none || source.isNull())
+            return source;
+
+        if (! (source == simulatedSource) || deficiency != simulatedDeficiency)
+        {
+            simulated = pool.acquire (source.getFormat(), source.getWidth(), source.getHeight());
+            ColourVision::simulate (source, simulated, deficiency);
+
+            simulatedSource = source;
+            simulatedDeficiency = deficiency;
+        }
+
+        return simulated;
+    }
+
+    /** Forgets the simulation, for example when the source image was changed in place. */
+    void reset()
+    {
+        simulated = {};
+        simulatedSource = {};
+    }
+
+    size_t getBytes() const
+    {
+        return RasterCache::getImageBytes (simulated);
+    }
+
+    juce::Image simulated, simulatedSource;
+    ColourVision::Deficiency simulatedDeficiency = ColourVision::Deficiency::none;
+};
+
+/** Hashes the values that determine a rendered image, for merging identical render jobs. */
+static juce::int64 getRenderKey (std::initializer_list<float> values)
+{
+    auto hash = (juce::uint64) 14695981039346656037ull;
+
+    for (auto v : values)
+    {
+        juce::uint32 bits;
+        std::memcpy (&bits, &v, sizeof (bits));
+        hash = (hash ^ bits) * 1099511628211ull;
+    }
+
+    return (juce::int64) hash;
+}
+
+/** Renders an image at a fraction of its physical size into a pooled raster, and
+    tells the governor how long that took. A reduced image is stretched to the
+    physical size when drawn, so nothing is allocated once the pool is warm. The
+    pool hands out software images, so this can run on the render scheduler's threads.
+*/
+template <typename RenderFunction>
+static juce::Image renderAtQuality (juce::Point<int> size, float quality, RenderQualityGovernor& governor,
+                                    RasterPool& pool, RenderFunction&& render)
+{
+    auto width  = juce::jmax (1, juce::roundToInt ((float) size.x * quality));
+    auto height = juce::jmax (1, juce::roundToInt ((float) size.y * quality));
+
+    auto raster = pool.acquire (juce::Image::RGB, width, height);
+
+    auto start = juce::Time::getMillisecondCounterHiRes();
+    render (raster);
+    governor.addMeasurement (width * height, juce::Time::getMillisecondCounterHiRes() - start);
+
+    return raster;
+}
+
+namespace
+{
+    /** A label or text editor whose tooltip is the name of the colour it shows.
+        Finding the name searches the named colours, so it is only done when the
+        tooltip is about to be shown, rather than each time the colour changes.
+    */
+    template <typename ComponentType>
+    class ColourNameTooltip  : public ComponentType
+    {
+    public:
+        explicit ColourNameTooltip (std::function<DeepColour()> colourToName)
+            : getColour (std::move (colourToName))
+        {
+        }
+
+        juce::String getTooltip() override
+        {
+            return NamedColours::getDisplayName (getColour());
+        }
+
+    private:
+        std::function<DeepColour()> getColour;
+    };
+}
+
 //==============================================================================
 class ColourSelector::OriginalColourComp : public juce::Component
 {
@@ -40,10 +216,10 @@ public:
                             juce::Colour (0xffdddddd),
                             juce::Colour (0xffffffff));
 
-        g.setColour (owner.colour.getColour());
+        g.setColour (owner.getDisplayColour (owner.colour.getColour()));
         g.fillRect (rc.removeFromTop (rc.getHeight() / 2));
 
-        g.setColour (owner.originalColour.getColour());
+        g.setColour (owner.getDisplayColour (owner.originalColour.getColour()));
         g.fillRect (rc);
     }
 
@@ -51,7 +227,9 @@ public:
 };
 
 //==============================================================================
-class ColourSelector::Parameter2D : public Component
+class ColourSelector::Parameter2D : public Component,
+                                    public RasterCache::Owner,
+                                    private juce::Timer
 {
 public:
     Parameter2D (ColourSelector& cs, int edgeSize)
@@ -60,6 +238,16 @@ public:
         setWantsKeyboardFocus (true);
         addAndMakeVisible (marker);
         setMouseCursor (juce::MouseCursor::CrosshairCursor);
+
+        renderTarget.onRenderFinished = [this] (const juce::Image& image)
+        {
+            colours = image;
+            imageSize = pendingSize;
+            imageScale = pendingScale;
+            imageQuality = pendingQuality;
+            imageKey = pendingKey;
+            repaint();
+        };
     }
 
     void setParameters (Params x_, Params y_)
@@ -67,29 +255,305 @@ public:
         xParam = x_;
         yParam = y_;
 
+        colours = {};
+        renderTarget.cancelRender();
         updateIfNeeded();
     }
 
     void paint (juce::Graphics& g) override
     {
+        auto area = getLocalBounds().reduced (edge);
+
+        if (area.isEmpty())
+            return;
+
+        auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+
+        // The first image is rendered straight away. Later ones are rendered in the
+        // background by the shared scheduler, while the previous one is still shown.
         if (colours.isNull())
-            updateImage();
+            updateImage (area, scale);
+        else
+            requestImage (area, scale, owner.isDragging());
+
+        drawPhysicalImage (g, simulatedImage.get (colours, owner.colourVision, *getRasterPool()), area, imageScale, *owner.planeGovernor);
+    }
+
+    void updateImage (juce::Rectangle<int> area, float scale)
+    {
+        auto size = getPhysicalSize (area, scale);
+        auto quality = owner.planeGovernor->getQuality (size.x * size.y, false);
+
+        renderTarget.cancelRender();
 
-        g.setOpacity (1.0f);
-        g.drawImageTransformed (colours,
-                                juce::RectanglePlacement (juce::RectanglePlacement::stretchToFit)
-                                    .getTransformToFit (colours.getBounds().toFloat(),
-                                                        getLocalBounds().reduced (edge).toFloat()),
-                                false);
+        colours = createImage (size, quality, *owner.planeGovernor, *getRasterPool(), owner.colour, xParam, yParam,
+                               owner.workingSpace, getContrastLuminance(), owner.densityHistogram);
+        imageSize = size;
+        imageScale = scale;
+        imageQuality = quality;
+        imageKey = getImageKey();
     }
 
-    void updateImage()
+    void requestImage (juce::Rectangle<int> area, float scale, bool dragging)
     {
-        auto width = getWidth() / 2;
-        auto height = getHeight() / 2;
-        colours = juce::Image (juce::Image::RGB, width, height, false);
+        auto size = getPhysicalSize (area, scale);
+        auto key = getImageKey();
+        auto quality = owner.planeGovernor->getQuality (size.x * size.y, dragging);
+
+        // an image that is at least as good as the one needed is kept
+        if (colours.isValid() && imageSize == size
+             && juce::approximatelyEqual (scale, imageScale) && key == imageKey && imageQuality >= quality)
+        {
+            renderTarget.cancelRender();
+            return;
+        }
+
+        // once the input has been idle for a while, the reduced image is replaced by a full quality one
+        if (quality < owner.planeGovernor->getSettings().maxQuality)
+            startTimer (owner.planeGovernor->getSettings().idleMs);
+
+        pendingSize = size;
+        pendingScale = scale;
+        pendingQuality = quality;
+        pendingKey = key;
+
+        auto governor = owner.planeGovernor;
+        auto pool = getRasterPool();
+        auto colour = owner.colour;
+        auto x = xParam;
+        auto y = yParam;
+        auto space = owner.workingSpace;
+        auto contrast = key[3];
+        auto density = owner.densityHistogram;
+
+        renderTarget.requestRender (owner.getRenderPriority(),
+                                    getRenderKey ({ 2.0f, (float) size.x, (float) size.y, quality, (float) (int) x, (float) (int) y, key[0], key[1], key[2], key[3], key[4], key[5] }),
+                                    [=] { return createImage (size, quality, *governor, *pool, colour, x, y, space, contrast, density); });
+    }
+
+    void timerCallback() override
+    {
+        stopTimer();
+        requestImage (getLocalBounds().reduced (edge), imageScale, false);
+    }
+
+    size_t getCacheBytes() const override
+    {
+        return RasterCache::getImageBytes (colours) + simulatedImage.getBytes();
+    }
+
+    void releaseCache() override
+    {
+        colours = {};
+        simulatedImage.reset();
+        renderTarget.cancelRender();
+        stopTimer();
+    }
+
+    bool isCacheShowing() const override
+    {
+        return isShowing() || owner.playingTrace;
+    }
+
+    /** Renders the plane. A contrast luminance of zero or more adds the contrast lines
+        for it, and a histogram dims the areas that hold few of its colours.
+    */
+    static juce::Image createImage (juce::Point<int> size, float quality, RenderQualityGovernor& governor,
+                                    RasterPool& pool, const DeepColour& colour, Params xParam, Params yParam,
+                                    WorkingSpace space, float contrastLuminance,
+                                    const std::shared_ptr<const ColourHistogram>& density)
+    {
+        return renderAtQuality (size, quality, governor, pool, [&] (juce::Image& image)
+        {
+            if (isRGBParam (xParam))
+                renderRGBPlane (image, colour, xParam, yParam, space);
+            else
+                renderPlane (image, colour, xParam, yParam);
+
+            // the contrast is measured before the density dims the colours
+            if (contrastLuminance >= 0.0f)
+                renderContrastLines (image, contrastLuminance);
+
+            // the histogram's red, green and blue axes are sRGB, so they only match an sRGB plane
+            if (density != nullptr && (! isRGBParam (xParam) || space == WorkingSpace::sRGB))
+            {
+                auto components = getComponents (colour, xParam, space);
+                auto fixed = components[(size_t) (3 - getComponentIndex (xParam) - getComponentIndex (yParam))];
+
+                renderDensity (image, *density, xParam, yParam, fixed);
+            }
+        });
+    }
+
+    /** Dims each pixel of the plane by how few of the histogram's colours project onto it.
+        Only the colours within a slice around the plane's fixed component are counted.
+    */
+    static void renderDensity (juce::Image& image, const ColourHistogram& histogram, Params xParam, Params yParam, float fixed)
+    {
+        constexpr auto bins = ColourHistogram::numBins;
+
+        // four bins wide, so the slice doesn't jump between bins as the component changes
+        constexpr auto sliceHalfWidth = 2.0f / float (bins);
 
-        juce::Image::BitmapData pixels (colours, juce::Image::BitmapData::writeOnly);
+        auto width = image.getWidth();
+        auto height = image.getHeight();
+
+        thread_local std::array<float, bins * bins> grid, wrapped;
+        thread_local std::vector<int> column0, column1;
+        thread_local std::vector<float> columnT;
+
+        auto xAxis = (ColourHistogram::Axis) (int) xParam;
+        auto yAxis = (ColourHistogram::Axis) (int) yParam;
+        auto minimum = fixed - sliceHalfWidth;
+        auto maximum = fixed + sliceHalfWidth;
+
+        auto maxCount = histogram.project (xAxis, yAxis, grid.data(), minimum, maximum);
+
+        // the hue wraps around, so a slice across red also takes the bins at the other end
+        auto isHueSlice = ! isRGBParam (xParam) && xParam != Params::hue && yParam != Params::hue;
+
+        if (isHueSlice && (minimum < 0.0f || maximum > 1.0f))
+        {
+            if (minimum < 0.0f)
+                histogram.project (xAxis, yAxis, wrapped.data(), minimum + 1.0f, 1.0f);
+            else
+                histogram.project (xAxis, yAxis, wrapped.data(), 0.0f, maximum - 1.0f);
+
+            for (size_t i = 0; i < grid.size(); ++i)
+                grid[i] += wrapped[i];
+
+            maxCount = *std::max_element (grid.begin(), grid.end());
+        }
+
+        if (maxCount <= 0.0f)
+            return;
+
+        // logarithmic, so that colours that cover little of the image still show
+        auto scale = 1.0f / std::log1p (maxCount);
+
+        for (auto& v : grid)
+            v = std::log1p (v) * scale;
+
+        // the grid is sampled bilinearly between the bin centres
+        auto locate = [] (float position, int& i0, int& i1, float& t)
+        {
+            auto p = juce::jlimit (0.0f, float (bins - 1), position * float (bins) - 0.5f);
+            i0 = int (p);
+            i1 = juce::jmin (i0 + 1, bins - 1);
+            t = p - float (i0);
+        };
+
+        column0.resize ((size_t) width);
+        column1.resize ((size_t) width);
+        columnT.resize ((size_t) width);
+
+        for (int x = 0; x < width; ++x)
+            locate ((float (x) + 0.5f) / float (width), column0[(size_t) x], column1[(size_t) x], columnT[(size_t) x]);
+
+        juce::Image::BitmapData pixels (image, juce::Image::BitmapData::readWrite);
+
+        for (int y = 0; y < height; ++y)
+        {
+            int row0, row1;
+            float rowT;
+            locate (1.0f - (float (y) + 0.5f) / float (height), row0, row1, rowT);
+
+            auto* top = grid.data() + row0 * bins;
+            auto* bottom = grid.data() + row1 * bins;
+            auto* line = pixels.getLinePointer (y);
+
+            for (int x = 0; x < width; ++x)
+            {
+                auto c0 = column0[(size_t) x];
+                auto c1 = column1[(size_t) x];
+                auto t  = columnT[(size_t) x];
+
+                auto a = top[c0]    + (top[c1]    - top[c0])    * t;
+                auto b = bottom[c0] + (bottom[c1] - bottom[c0]) * t;
+                auto density = a + (b - a) * rowT;
+
+                // areas without any of the image's colours keep 35% of their brightness
+                auto factor = juce::uint32 ((0.35f + 0.65f * density) * 256.0f);
+                auto* p = (juce::PixelRGB*) (line + x * pixels.pixelStride);
+
+                p->setARGB (255,
+                            juce::uint8 ((p->getRed()   * factor) >> 8),
+                            juce::uint8 ((p->getGreen() * factor) >> 8),
+                            juce::uint8 ((p->getBlue()  * factor) >> 8));
+            }
+        }
+    }
+
+    /** Draws lines where the contrast ratio against a reference luminance crosses
+        3:1, 4.5:1 and 7:1. Stronger levels get more opaque lines.
+    */
+    static void renderContrastLines (juce::Image& image, float referenceLuminance)
+    {
+        auto width = image.getWidth();
+        auto height = image.getHeight();
+
+        // kept by each render thread, so that drags don't allocate once warmed up
+        thread_local std::vector<float> red, green, blue, ratio;
+        thread_local std::vector<juce::uint8> levels, levelsAbove;
+
+        for (auto* v : { &red, &green, &blue, &ratio })
+            v->resize ((size_t) width);
+
+        levels.resize ((size_t) width);
+        levelsAbove.resize ((size_t) width);
+
+        juce::Image::BitmapData pixels (image, juce::Image::BitmapData::readWrite);
+
+        for (int y = 0; y < height; ++y)
+        {
+            auto* line = pixels.getLinePointer (y);
+
+            for (int x = 0; x < width; ++x)
+            {
+                auto* p = (juce::PixelRGB*) (line + x * pixels.pixelStride);
+                red[(size_t) x]   = srgb8ToLinear (p->getRed());
+                green[(size_t) x] = srgb8ToLinear (p->getGreen());
+                blue[(size_t) x]  = srgb8ToLinear (p->getBlue());
+            }
+
+            ColourDifference::contrastRatio (referenceLuminance, red.data(), green.data(), blue.data(), ratio.data(), width);
+
+            for (int x = 0; x < width; ++x)
+            {
+                auto r = ratio[(size_t) x];
+                levels[(size_t) x] = juce::uint8 ((r >= 3.0f) + (r >= 4.5f) + (r >= 7.0f));
+            }
+
+            for (int x = 0; x < width; ++x)
+            {
+                auto level = levels[(size_t) x];
+                auto left  = x > 0 ? levels[(size_t) x - 1] : level;
+                auto above = y > 0 ? levelsAbove[(size_t) x] : level;
+
+                if (level == left && level == above)
+                    continue;
+
+                // a light line on dark colours and a dark line on light ones
+                auto strongest = juce::jmax (level, left, above);
+                auto* p = (juce::PixelRGB*) (line + x * pixels.pixelStride);
+                auto luminance = 0.2126f * red[(size_t) x] + 0.7152f * green[(size_t) x] + 0.0722f * blue[(size_t) x];
+                auto shade = juce::uint8 (luminance > 0.18f ? 0 : 255);
+
+                juce::PixelARGB ink (juce::uint8 (strongest * 85), shade, shade, shade);
+                ink.premultiply();
+                p->blend (ink);
+            }
+
+            std::swap (levels, levelsAbove);
+        }
+    }
+
+    static void renderPlane (juce::Image& image, const DeepColour& colour, Params xParam, Params yParam)
+    {
+        auto width = image.getWidth();
+        auto height = image.getHeight();
+
+        juce::Image::BitmapData pixels (image, juce::Image::BitmapData::writeOnly);
 
         for (int y = 0; y < height; ++y)
         {
@@ -99,7 +563,7 @@ public:
             {
                 auto xVal = (float) x / (float) width;
 
-                auto c = owner.colour;
+                auto c = colour;
 
                 auto set = [&] (Params param, float val)
                 {
@@ -121,24 +585,6 @@ public:
                         hsb.b = juce::jlimit (0.0f, 1.0f, val);
                         c = DeepColour (hsb);
                     }
-                    else if (param == Params::red)
-                    {
-                        auto rgb = c.getRGB();
-                        rgb.r = juce::jlimit (0.0f, 1.0f, val);
-                        c = DeepColour (rgb);
-                    }
-                    else if (param == Params::blue)
-                    {
-                        auto rgb = c.getRGB();
-                        rgb.b = juce::jlimit (0.0f, 1.0f, val);
-                        c = DeepColour (rgb);
-                    }
-                    else if (param == Params::green)
-                    {
-                        auto rgb = c.getRGB();
-                        rgb.g = juce::jlimit (0.0f, 1.0f, val);
-                        c = DeepColour (rgb);
-                    }
                     else
                     {
                         jassertfalse;
@@ -153,6 +599,58 @@ public:
         }
     }
 
+    /** Renders a plane of two of the red, green and blue components in a working space.
+        Each row is converted to sRGB in one batch, which uses the fast transfer curves.
+    */
+    static void renderRGBPlane (juce::Image& image, const DeepColour& colour, Params xParam, Params yParam, WorkingSpace space)
+    {
+        auto width = image.getWidth();
+        auto height = image.getHeight();
+
+        thread_local std::vector<float> reds, greens, blues;
+
+        reds.resize ((size_t) width);
+        greens.resize ((size_t) width);
+        blues.resize ((size_t) width);
+
+        auto channel = [&] (Params param) -> std::vector<float>&
+        {
+            return param == Params::red ? reds : param == Params::green ? greens : blues;
+        };
+
+        auto rgb = colour.getRGB (space);
+
+        // colours outside the sRGB gamut are clipped
+        auto toByte = [] (float v) { return (juce::uint8) juce::jlimit (0, 255, juce::roundToInt (v * 255.0f)); };
+
+        juce::Image::BitmapData pixels (image, juce::Image::BitmapData::writeOnly);
+
+        for (int y = 0; y < height; ++y)
+        {
+            std::fill (reds.begin(), reds.end(), rgb.r);
+            std::fill (greens.begin(), greens.end(), rgb.g);
+            std::fill (blues.begin(), blues.end(), rgb.b);
+
+            auto& xValues = channel (xParam);
+
+            for (int x = 0; x < width; ++x)
+                xValues[(size_t) x] = (float) x / (float) width;
+
+            auto& yValues = channel (yParam);
+            std::fill (yValues.begin(), yValues.end(), 1.0f - (float) y / (float) height);
+
+            convertRGB (reds.data(), greens.data(), blues.data(), width, space, WorkingSpace::sRGB);
+
+            auto* line = pixels.getLinePointer (y);
+
+            for (int x = 0; x < width; ++x)
+            {
+                auto* p = (juce::PixelRGB*) (line + x * pixels.pixelStride);
+                p->setARGB (255, toByte (reds[(size_t) x]), toByte (greens[(size_t) x]), toByte (blues[(size_t) x]));
+            }
+        }
+    }
+
     void mouseDown (const juce::MouseEvent& e) override
     {
         grabKeyboardFocus();
@@ -186,21 +684,21 @@ public:
             }
             else if (param == Params::red)
             {
-                auto rgb = owner.colour.getRGB();
+                auto rgb = owner.getWorkingRGB();
                 rgb.r = juce::jlimit (0.0f, 1.0f, val);
-                owner.set (DeepColour::fromRGBA (rgb.r, rgb.g, rgb.b, owner.colour.getAlpha()));
+                owner.set (DeepColour::fromRGB (rgb, owner.workingSpace, owner.colour.getAlpha()));
             }
             else if (param == Params::blue)
             {
-                auto rgb = owner.colour.getRGB();
+                auto rgb = owner.getWorkingRGB();
                 rgb.b = juce::jlimit (0.0f, 1.0f, val);
-                owner.set (DeepColour::fromRGBA (rgb.r, rgb.g, rgb.b, owner.colour.getAlpha()));
+                owner.set (DeepColour::fromRGB (rgb, owner.workingSpace, owner.colour.getAlpha()));
             }
             else if (param == Params::green)
             {
-                auto rgb = owner.colour.getRGB();
+                auto rgb = owner.getWorkingRGB();
                 rgb.g = juce::jlimit (0.0f, 1.0f, val);
-                owner.set (DeepColour::fromRGBA (rgb.r, rgb.g, rgb.b, owner.colour.getAlpha()));
+                owner.set (DeepColour::fromRGB (rgb, owner.workingSpace, owner.colour.getAlpha()));
             }
             else
             {
@@ -214,14 +712,18 @@ public:
 
     void updateIfNeeded()
     {
-        colours = {};
-        repaint();
+        // Moving the marker repaints its old and new bounds, so the whole plane
+        // only needs repainting once the image itself looks different
+        if (colours.isNull())
+            repaint();
+        else
+            requestImage (getLocalBounds().reduced (edge), imageScale, owner.isDragging());
+
         updateMarker();
     }
 
     void resized() override
     {
-        colours = {};
         updateMarker();
     }
 
@@ -229,14 +731,40 @@ private:
     ColourSelector& owner;
     const int edge;
     juce::Image colours;
+    SimulatedImage simulatedImage;
+    juce::Point<int> imageSize, pendingSize;
+    float imageScale = 1.0f, pendingScale = 1.0f;
+    float imageQuality = 1.0f, pendingQuality = 1.0f;
+    std::array<float, 6> imageKey {}, pendingKey {};
+    RenderScheduler::Target renderTarget;
     Params xParam = Params::hue;
     Params yParam = Params::saturation;
 
+    /** Returns the values that determine the image: the components that aren't on
+        an axis, the contrast luminance, the density histogram and the working space.
+    */
+    std::array<float, 6> getImageKey() const
+    {
+        auto components = getComponents (owner.colour, xParam, owner.workingSpace);
+        components[getComponentIndex (xParam)] = 0.0f;
+        components[getComponentIndex (yParam)] = 0.0f;
+        return { components[0], components[1], components[2], getContrastLuminance(),
+                 owner.densityHistogram != nullptr ? (float) owner.densityGeneration : -1.0f,
+                 (float) (int) owner.workingSpace };
+    }
+
+    /** Returns the luminance of the contrast reference, or -1 if there is none. */
+    float getContrastLuminance() const
+    {
+        return owner.contrastReference.has_value() ? ColourDifference::relativeLuminance (*owner.contrastReference) : -1.0f;
+    }
+
     struct Parameter2DMarker  : public Component
     {
         Parameter2DMarker()
         {
             setInterceptsMouseClicks (false, false);
+            setBufferedToImage (true);
         }
 
         void paint (juce::Graphics& g) override
@@ -258,17 +786,17 @@ private:
         auto get = [&] (Params param)
         {
             if (param == Params::hue)
-                return owner.colour.getHSB().h;
+                return owner.model->getHSB().h;
             else if (param == Params::saturation)
-                return owner.colour.getHSB().s;
+                return owner.model->getHSB().s;
             else if (param == Params::brightness)
-                return owner.colour.getHSB().b;
+                return owner.model->getHSB().b;
             else if (param == Params::red)
-                return owner.colour.getRGB().r;
+                return owner.getWorkingRGB().r;
             else if (param == Params::blue)
-                return owner.colour.getRGB().b;
+                return owner.getWorkingRGB().b;
             else if (param == Params::green)
-                return owner.colour.getRGB().g;
+                return owner.getWorkingRGB().g;
             else
                 jassertfalse;
             return 0.0f;
@@ -281,7 +809,9 @@ private:
 };
 
 //==============================================================================
-class ColourSelector::Parameter1D  : public Component
+class ColourSelector::Parameter1D  : public Component,
+                                     public RasterCache::Owner,
+                                     private juce::Timer
 {
 public:
     Parameter1D (ColourSelector& cs, int edgeSize)
@@ -289,70 +819,208 @@ public:
     {
         setWantsKeyboardFocus (true);
         addAndMakeVisible (marker);
+
+        renderTarget.onRenderFinished = [this] (const juce::Image& image)
+        {
+            strip = image;
+            imageSize = pendingSize;
+            imageScale = pendingScale;
+            imageQuality = pendingQuality;
+            imageKey = pendingKey;
+            repaint();
+        };
     }
 
     void setParameter (Params p)
     {
         param = p;
 
+        strip = {};
+        renderTarget.cancelRender();
         updateIfNeeded();
     }
 
     void paint (juce::Graphics& g) override
     {
-        juce::ColourGradient cg;
-        cg.isRadial = false;
-        cg.point1.setXY (0.0f, (float) edge);
-        cg.point2.setXY (0.0f, (float) getHeight());
+        auto area = getLocalBounds().reduced (edge);
+
+        if (area.isEmpty())
+            return;
+
+        auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+
+        if (strip.isNull())
+            updateImage (area, scale);
+        else
+            requestImage (area, scale, owner.isDragging());
+
+        drawPhysicalImage (g, simulatedImage.get (strip, owner.colourVision, *getRasterPool()), area, imageScale, *owner.stripGovernor);
+    }
+
+    void updateImage (juce::Rectangle<int> area, float scale)
+    {
+        auto size = getPhysicalSize (area, scale);
+        auto quality = owner.stripGovernor->getQuality (size.x * size.y, false);
 
-        auto c = owner.colour;
-        for (float i = 0.0f; i <= 1.0f; i += 0.02f)
+        renderTarget.cancelRender();
+
+        strip = createImage (size, quality, *owner.stripGovernor, *getRasterPool(), owner.colour, param, owner.workingSpace);
+        imageSize = size;
+        imageScale = scale;
+        imageQuality = quality;
+        imageKey = getImageKey();
+    }
+
+    void requestImage (juce::Rectangle<int> area, float scale, bool dragging)
+    {
+        auto size = getPhysicalSize (area, scale);
+        auto key = getImageKey();
+        auto quality = owner.stripGovernor->getQuality (size.x * size.y, dragging);
+
+        // an image that is at least as good as the one needed is kept
+        if (strip.isValid() && imageSize == size
+             && juce::approximatelyEqual (scale, imageScale) && key == imageKey && imageQuality >= quality)
         {
-            if (param == Params::hue)
-            {
-                HSB hsb;
-                hsb.h = 1.0f - i;
-                hsb.s = 1.0f;
-                hsb.b = 1.0f;
-                cg.addColour (i, DeepColour (hsb).getColour());
-            }
-            else if (param == Params::saturation)
-            {
-                auto hsb = c.getHSB();
-                hsb.s = 1.0f - i;
-                cg.addColour (i, DeepColour (hsb).getColour());
-            }
-            else if (param == Params::brightness)
-            {
-                auto hsb = c.getHSB();
-                hsb.b = 1.0f - i;
-                cg.addColour (i, DeepColour (hsb).getColour());
-            }
-            else if (param == Params::red)
-            {
-                auto rgb = c.getRGB();
-                rgb.r = 1.0f - i;
-                cg.addColour (i, DeepColour (rgb).getColour());
-            }
-            else if (param == Params::blue)
+            renderTarget.cancelRender();
+            return;
+        }
+
+        // once the input has been idle for a while, the reduced image is replaced by a full quality one
+        if (quality < owner.stripGovernor->getSettings().maxQuality)
+            startTimer (owner.stripGovernor->getSettings().idleMs);
+
+        pendingSize = size;
+        pendingScale = scale;
+        pendingQuality = quality;
+        pendingKey = key;
+
+        auto governor = owner.stripGovernor;
+        auto pool = getRasterPool();
+        auto colour = owner.colour;
+        auto p = param;
+        auto space = owner.workingSpace;
+
+        renderTarget.requestRender (owner.getRenderPriority(),
+                                    getRenderKey ({ 1.0f, (float) size.x, (float) size.y, quality, (float) (int) p, key[0], key[1], key[2], key[3] }),
+                                    [=] { return createImage (size, quality, *governor, *pool, colour, p, space); });
+    }
+
+    void timerCallback() override
+    {
+        stopTimer();
+        requestImage (getLocalBounds().reduced (edge), imageScale, false);
+    }
+
+    size_t getCacheBytes() const override
+    {
+        return RasterCache::getImageBytes (strip) + simulatedImage.getBytes();
+    }
+
+    void releaseCache() override
+    {
+        strip = {};
+        simulatedImage.reset();
+        renderTarget.cancelRender();
+        stopTimer();
+    }
+
+    bool isCacheShowing() const override
+    {
+        return isShowing() || owner.playingTrace;
+    }
+
+    static juce::Image createImage (juce::Point<int> size, float quality, RenderQualityGovernor& governor,
+                                    RasterPool& pool, const DeepColour& colour, Params param, WorkingSpace space)
+    {
+        return renderAtQuality (size, quality, governor, pool, [&] (juce::Image& image) { renderStrip (image, colour, param, space); });
+    }
+
+    static void renderStrip (juce::Image& image, const DeepColour& colour, Params param, WorkingSpace space)
+    {
+        auto width = image.getWidth();
+        auto height = image.getHeight();
+
+        // kept by each render thread, so that rendering a strip doesn't allocate once warmed up
+        thread_local GradientLUT gradient;
+        thread_local std::vector<juce::PixelARGB> lut;
+        thread_local std::vector<float> reds, greens, blues, alphas;
+
+        gradient.clearStops();
+
+        // the strip is an RGB image, so its stops are opaque: baked translucent stops
+        // would come out premultiplied, and so darkened
+        if (param == Params::hue)
+        {
+            gradient.setSpace (GradientLUT::Space::hsb);
+
+            for (int i = 0; i <= 6; ++i)
+                gradient.addStop ((float) i / 6.0f, DeepColour (HSB ((float) i / 6.0f, 1.0f, 1.0f)));
+        }
+        else if (param == Params::saturation || param == Params::brightness)
+        {
+            gradient.setSpace (GradientLUT::Space::hsb);
+
+            for (auto val : { 0.0f, 1.0f })
             {
-                auto rgb = c.getRGB();
-                rgb.b = 1.0f - i;
-                cg.addColour (i, DeepColour (rgb).getColour());
+                auto hsb = colour.getHSB();
+                (param == Params::saturation ? hsb.s : hsb.b) = val;
+                gradient.addStop (val, DeepColour (hsb));
             }
-            else if (param == Params::green)
+        }
+        else
+        {
+            // the stops hold working space values, which are interpolated as they
+            // are and then converted to sRGB in one batch
+            gradient.setSpace (GradientLUT::Space::sRGB);
+
+            for (auto val : { 0.0f, 1.0f })
             {
-                auto rgb = c.getRGB();
-                rgb.g = 1.0f - i;
-                cg.addColour (i, DeepColour (rgb).getColour());
+                auto rgb = colour.getRGB (space);
+                (param == Params::red ? rgb.r : param == Params::green ? rgb.g : rgb.b) = val;
+                gradient.addStop (val, DeepColour (rgb));
             }
         }
 
-        g.setGradientFill (cg);
-        g.fillRect (getLocalBounds().reduced (edge));
+        lut.resize ((size_t) height);
+
+        if (isRGBParam (param) && space != WorkingSpace::sRGB)
+        {
+            for (auto* channel : { &reds, &greens, &blues, &alphas })
+                channel->resize ((size_t) height);
+
+            gradient.bake (reds.data(), greens.data(), blues.data(), alphas.data(), height);
+            convertRGB (reds.data(), greens.data(), blues.data(), height, space, WorkingSpace::sRGB);
+
+            // the stops are opaque, and the colours outside the sRGB gamut are clipped
+            auto toByte = [] (float v) { return juce::uint8 (juce::jlimit (0.0f, 1.0f, v) * 255.0f + 0.5f); };
+
+            for (size_t i = 0; i < lut.size(); ++i)
+                lut[i].setARGB (255, toByte (reds[i]), toByte (greens[i]), toByte (blues[i]));
+        }
+        else
+        {
+            gradient.bake (lut.data(), height);
+        }
+
+        juce::Image::BitmapData pixels (image, juce::Image::BitmapData::writeOnly);
+
+        for (int y = 0; y < height; ++y)
+        {
+            // the top of the strip is the maximum value
+            auto pixel = lut[height - 1 - y];
+            auto* line = pixels.getLinePointer (y);
+
+            for (int x = 0; x < width; ++x)
+                ((juce::PixelRGB*) (line + x * pixels.pixelStride))->set (pixel);
+        }
     }
 
     void resized() override
+    {
+        updateMarker();
+    }
+
+    void updateMarker()
     {
         auto markerSize = juce::jmax (14, edge * 2);
         auto area = getLocalBounds().reduced (edge);
@@ -360,17 +1028,17 @@ public:
         auto get = [&] ()
         {
             if (param == Params::hue)
-                return owner.colour.getHSB().h;
+                return owner.model->getHSB().h;
             else if (param == Params::saturation)
-                return owner.colour.getHSB().s;
+                return owner.model->getHSB().s;
             else if (param == Params::brightness)
-                return owner.colour.getHSB().b;
+                return owner.model->getHSB().b;
             else if (param == Params::red)
-                return owner.colour.getRGB().r;
+                return owner.getWorkingRGB().r;
             else if (param == Params::blue)
-                return owner.colour.getRGB().b;
+                return owner.getWorkingRGB().b;
             else if (param == Params::green)
-                return owner.colour.getRGB().g;
+                return owner.getWorkingRGB().g;
             else
                 jassertfalse;
             return 0.0f;
@@ -409,21 +1077,21 @@ public:
         }
         else if (param == Params::red)
         {
-            auto rgb = owner.colour.getRGB();
+            auto rgb = owner.getWorkingRGB();
             rgb.r = juce::jlimit (0.0f, 1.0f, val);
-            owner.set (DeepColour::fromRGBA (rgb.r, rgb.g, rgb.b, owner.colour.getAlpha()));
+            owner.set (DeepColour::fromRGB (rgb, owner.workingSpace, owner.colour.getAlpha()));
         }
         else if (param == Params::blue)
         {
-            auto rgb = owner.colour.getRGB();
+            auto rgb = owner.getWorkingRGB();
             rgb.b = juce::jlimit (0.0f, 1.0f, val);
-            owner.set (DeepColour::fromRGBA (rgb.r, rgb.g, rgb.b, owner.colour.getAlpha()));
+            owner.set (DeepColour::fromRGB (rgb, owner.workingSpace, owner.colour.getAlpha()));
         }
         else if (param == Params::green)
         {
-            auto rgb = owner.colour.getRGB();
+            auto rgb = owner.getWorkingRGB();
             rgb.g = juce::jlimit (0.0f, 1.0f, val);
-            owner.set (DeepColour::fromRGBA (rgb.r, rgb.g, rgb.b, owner.colour.getAlpha()));
+            owner.set (DeepColour::fromRGB (rgb, owner.workingSpace, owner.colour.getAlpha()));
         }
         else
         {
@@ -431,49 +1099,375 @@ public:
         }
     }
 
+    void updateIfNeeded()
+    {
+        if (strip.isNull())
+            repaint();
+        else
+            requestImage (getLocalBounds().reduced (edge), imageScale, owner.isDragging());
+
+        updateMarker();
+    }
+
+private:
+    ColourSelector& owner;
+    const int edge;
+    juce::Image strip;
+    SimulatedImage simulatedImage;
+    juce::Point<int> imageSize, pendingSize;
+    float imageScale = 1.0f, pendingScale = 1.0f;
+    float imageQuality = 1.0f, pendingQuality = 1.0f;
+    std::array<float, 4> imageKey {}, pendingKey {};
+    RenderScheduler::Target renderTarget;
+
+    /** Returns the components that aren't on the strip's axis, and the working space. */
+    std::array<float, 4> getImageKey() const
+    {
+        // the hue strip is always drawn fully saturated and bright
+        if (param == Params::hue)
+            return {};
+
+        auto components = getComponents (owner.colour, param, owner.workingSpace);
+        components[getComponentIndex (param)] = 0.0f;
+        return { components[0], components[1], components[2], (float) (int) owner.workingSpace };
+    }
+
+    struct Parameter1DMarker  : public Component
+    {
+        Parameter1DMarker()
+        {
+            setInterceptsMouseClicks (false, false);
+            setBufferedToImage (true);
+        }
+
+        void paint (juce::Graphics& g) override
+        {
+            auto cw = (float) getWidth();
+            auto ch = (float) getHeight();
+
+            juce::Path p;
+            p.addTriangle (1.0f, 1.0f,
+                           cw * 0.3f, ch * 0.5f,
+                           1.0f, ch - 1.0f);
+
+            p.addTriangle (cw - 1.0f, 1.0f,
+                           cw * 0.7f, ch * 0.5f,
+                           cw - 1.0f, ch - 1.0f);
+
+            g.setColour (juce::Colours::white.withAlpha (0.75f));
+            g.fillPath (p);
+
+            g.setColour (juce::Colours::black.withAlpha (0.75f));
+            g.strokePath (p, juce::PathStrokeType (1.2f));
+        }
+    };
+
+    Parameter1DMarker marker;
+    Params param = Params::hue;
+
+    JUCE_DECLARE_NON_COPYABLE (Parameter1D)
+};
+
+//==============================================================================
+/** A hue ring around a triangle of saturation and brightness.
+
+    The triangle doesn't turn with the hue. So the angle of each pixel of the
+    ring, the weights of the triangle's corners at each pixel inside it, and
+    which part each pixel belongs to only depend on the size. They are worked
+    out once per size, and a new hue only mixes each triangle pixel from its
+    two stored weights.
+*/
+class ColourSelector::HueWheel  : public Component,
+                                  public RasterCache::Owner
+{
+public:
+    HueWheel (ColourSelector& cs, int edgeSize)
+        : owner (cs), edge (edgeSize)
+    {
+        setWantsKeyboardFocus (true);
+        setMouseCursor (juce::MouseCursor::CrosshairCursor);
+    }
+
+    void paint (juce::Graphics& g) override
+    {
+        auto area = getWheelArea();
+
+        if (area.isEmpty())
+            return;
+
+        auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+        auto size = getPhysicalSize (area, scale);
+
+        if (image.isNull() || tableSize != size.x)
+            buildTables (size.x, scale);
+
+        auto hsb = owner.model->getHSB();
+
+        if (! juce::approximatelyEqual (hsb.h, renderedHue))
+            renderTriangle (hsb.h);
+
+        drawPhysicalImage (g, simulatedImage.get (image, owner.colourVision, *getRasterPool()), area, scale);
+
+        // the markers are drawn in logical coordinates
+        auto centre = area.getCentre().toFloat();
+        auto outer = (float) area.getWidth() * 0.5f;
+        auto angle = hsb.h * juce::MathConstants<float>::twoPi;
+        auto direction = juce::Point<float> (std::cos (angle), -std::sin (angle));
+
+        g.setColour (juce::Colours::white);
+        g.drawLine ({ centre + direction * outer * innerRadius, centre + direction * outer }, 3.0f);
+        g.setColour (juce::Colours::black);
+        g.drawLine ({ centre + direction * outer * innerRadius, centre + direction * outer }, 1.0f);
+
+        auto marker = centre + getTrianglePoint (hsb.s, hsb.b) * outer;
+        g.setColour (juce::Colour::greyLevel (0.1f));
+        g.drawEllipse (juce::Rectangle<float> (11.0f, 11.0f).withCentre (marker), 1.0f);
+        g.setColour (juce::Colour::greyLevel (0.9f));
+        g.drawEllipse (juce::Rectangle<float> (9.0f, 9.0f).withCentre (marker), 1.0f);
+    }
+
+    void mouseDown (const juce::MouseEvent& e) override
+    {
+        grabKeyboardFocus();
+
+        // the part under the mouse comes from the table, once it is built
+        auto area = getWheelArea();
+        auto p = ((e.position - area.getPosition().toFloat()) * tableScale).toInt();
+
+        dragPart = Part::none;
+
+        if (juce::isPositiveAndBelow (p.x, tableSize) && juce::isPositiveAndBelow (p.y, tableSize))
+            dragPart = (Part) parts[size_t (p.y * tableSize + p.x)];
+
+        mouseDrag (e);
+    }
+
+    void mouseDrag (const juce::MouseEvent& e) override
+    {
+        auto area = getWheelArea();
+
+        if (area.isEmpty() || dragPart == Part::none)
+            return;
+
+        auto outer = (float) area.getWidth() * 0.5f;
+        auto p = (e.position - area.getCentre().toFloat()) / outer;
+        auto hsb = owner.model->getHSB();
+
+        if (dragPart == Part::ring)
+        {
+            auto hue = std::atan2 (-p.y, p.x) / juce::MathConstants<float>::twoPi;
+            hsb.h = hue < 0.0f ? hue + 1.0f : hue;
+        }
+        else
+        {
+            auto w = getCornerWeights (p);
+
+            // outside the triangle, the nearest point on its edge is roughly
+            // where the weights that became negative are zero
+            auto wHue   = juce::jmax (0.0f, w[0]);
+            auto wWhite = juce::jmax (0.0f, w[1]);
+            auto wBlack = juce::jmax (0.0f, w[2]);
+            auto total  = wHue + wWhite + wBlack;
+
+            wHue /= total;
+            wWhite /= total;
+
+            hsb.b = juce::jlimit (0.0f, 1.0f, wHue + wWhite);
+            hsb.s = hsb.b > 0.0f ? juce::jlimit (0.0f, 1.0f, wHue / hsb.b) : 0.0f;
+        }
+
+        owner.set (DeepColour::fromHSB (hsb.h, hsb.s, hsb.b, owner.colour.getAlpha()));
+    }
+
     void updateIfNeeded()
     {
         repaint();
-        resized();
+    }
+
+    size_t getCacheBytes() const override
+    {
+        return RasterCache::getImageBytes (image)
+                + simulatedImage.getBytes()
+                + parts.size() * sizeof (juce::uint8)
+                + triangle.size() * sizeof (TrianglePixel);
+    }
+
+    void releaseCache() override
+    {
+        image = {};
+        simulatedImage.reset();
+        parts = {};
+        triangle = {};
+        tableSize = 0;
+    }
+
+    bool isCacheShowing() const override
+    {
+        return isShowing() || owner.playingTrace;
     }
 
 private:
+    enum class Part : juce::uint8
+    {
+        none,
+        ring,
+        triangle
+    };
+
+    /** A pixel inside the triangle, and the weights of its hue and white corners. */
+    struct TrianglePixel
+    {
+        int offset;
+        float hueWeight, whiteWeight;
+        juce::uint8 alpha;
+    };
+
+    static constexpr float innerRadius = 0.78f;
+    static constexpr float triangleRadius = 0.74f;
+
     ColourSelector& owner;
     const int edge;
 
-    struct Parameter1DMarker  : public Component
-    {
-        Parameter1DMarker()
-        {
-            setInterceptsMouseClicks (false, false);
+    juce::Image image;
+    SimulatedImage simulatedImage;
+    std::vector<juce::uint8> parts;
+    std::vector<TrianglePixel> triangle;
+    int tableSize = 0;
+    float tableScale = 1.0f;
+    float renderedHue = -1.0f;
+    Part dragPart = Part::none;
+
+    juce::Rectangle<int> getWheelArea() const
+    {
+        auto area = getLocalBounds().reduced (edge);
+        auto side = juce::jmin (area.getWidth(), area.getHeight());
+        return area.withSizeKeepingCentre (side, side);
+    }
+
+    /** Returns the corners of the triangle, relative to the centre of a wheel of radius 1:
+        the hue at the top, white at the bottom right and black at the bottom left.
+    */
+    static std::array<juce::Point<float>, 3> getCorners()
+    {
+        auto corner = [] (float degrees)
+        {
+            auto a = juce::degreesToRadians (degrees);
+            return juce::Point<float> (std::cos (a), std::sin (a)) * triangleRadius;
+        };
+
+        return { corner (-90.0f), corner (30.0f), corner (150.0f) };
+    }
+
+    /** Returns the weights of the hue, white and black corners at a point. */
+    static std::array<float, 3> getCornerWeights (juce::Point<float> p)
+    {
+        auto [h, w, b] = getCorners();
+
+        auto denominator = (w.y - b.y) * (h.x - b.x) + (b.x - w.x) * (h.y - b.y);
+        auto wHue   = ((w.y - b.y) * (p.x - b.x) + (b.x - w.x) * (p.y - b.y)) / denominator;
+        auto wWhite = ((b.y - h.y) * (p.x - b.x) + (h.x - b.x) * (p.y - b.y)) / denominator;
+
+        return { wHue, wWhite, 1.0f - wHue - wWhite };
+    }
+
+    /** Returns the point of the triangle with a saturation and brightness. */
+    static juce::Point<float> getTrianglePoint (float saturation, float brightness)
+    {
+        auto [h, w, b] = getCorners();
+        auto wHue = saturation * brightness;
+        auto wWhite = brightness - wHue;
+
+        return h * wHue + w * wWhite + b * (1.0f - wHue - wWhite);
+    }
+
+    /** Works out the part, the hue or the corner weights, and the coverage of each
+        pixel, and draws the ring, which never changes.
+    */
+    void buildTables (int size, float scale)
+    {
+        tableSize = size;
+        tableScale = scale;
+        renderedHue = -1.0f;
+        simulatedImage.reset();
+
+        image = juce::Image (juce::Image::ARGB, size, size, true, juce::SoftwareImageType());
+        parts.assign ((size_t) (size * size), (juce::uint8) Part::none);
+        triangle.clear();
+
+        juce::Image::BitmapData pixels (image, juce::Image::BitmapData::writeOnly);
+
+        auto radius = (float) size * 0.5f;
+        auto inner = radius * innerRadius;
+
+        // the height of the triangle, in pixels
+        auto triangleHeight = radius * triangleRadius * 1.5f;
+
+        for (int y = 0; y < size; ++y)
+        {
+            for (int x = 0; x < size; ++x)
+            {
+                auto p = juce::Point<float> ((float) x + 0.5f - radius, (float) y + 0.5f - radius);
+                auto distance = p.getDistanceFromOrigin();
+                auto offset = y * pixels.lineStride + x * pixels.pixelStride;
+
+                // the coverage of the pixels on the edges gives smooth outlines
+                auto ringCoverage = juce::jlimit (0.0f, 1.0f, juce::jmin (radius - distance, distance - inner) + 0.5f);
+
+                if (ringCoverage > 0.0f)
+                {
+                    auto hue = std::atan2 (-p.y, p.x) / juce::MathConstants<float>::twoPi;
+                    auto rgb = hsbToRgb (HSB (hue < 0.0f ? hue + 1.0f : hue, 1.0f, 1.0f));
+                    auto alpha = juce::uint8 (ringCoverage * 255.0f);
+
+                    auto* pixel = (juce::PixelARGB*) (pixels.data + offset);
+                    pixel->setARGB (alpha, juce::uint8 (rgb.r * 255.0f), juce::uint8 (rgb.g * 255.0f), juce::uint8 (rgb.b * 255.0f));
+                    pixel->premultiply();
+
+                    parts[size_t (y * size + x)] = (juce::uint8) Part::ring;
+                    continue;
+                }
+
+                auto w = getCornerWeights (p / radius);
+                auto triangleCoverage = juce::jlimit (0.0f, 1.0f, juce::jmin (w[0], w[1], w[2]) * triangleHeight + 0.5f);
+
+                if (triangleCoverage > 0.0f)
+                {
+                    // clamped, so that the edge pixels outside the triangle can't overflow
+                    auto hueWeight = juce::jlimit (0.0f, 1.0f, w[0]);
+                    auto whiteWeight = juce::jlimit (0.0f, 1.0f - hueWeight, w[1]);
+
+                    triangle.push_back ({ offset, hueWeight, whiteWeight, juce::uint8 (triangleCoverage * 255.0f) });
+
+                    parts[size_t (y * size + x)] = (juce::uint8) Part::triangle;
+                }
+            }
         }
+    }
 
-        void paint (juce::Graphics& g) override
-        {
-            auto cw = (float) getWidth();
-            auto ch = (float) getHeight();
+    /** Mixes each triangle pixel from the hue and white with its stored weights. */
+    void renderTriangle (float hue)
+    {
+        renderedHue = hue;
 
-            juce::Path p;
-            p.addTriangle (1.0f, 1.0f,
-                           cw * 0.3f, ch * 0.5f,
-                           1.0f, ch - 1.0f);
+        // the image is changed in place, so its simulation is out of date
+        simulatedImage.reset();
 
-            p.addTriangle (cw - 1.0f, 1.0f,
-                           cw * 0.7f, ch * 0.5f,
-                           cw - 1.0f, ch - 1.0f);
+        auto rgb = hsbToRgb (HSB (hue, 1.0f, 1.0f));
+        juce::Image::BitmapData pixels (image, juce::Image::BitmapData::readWrite);
 
-            g.setColour (juce::Colours::white.withAlpha (0.75f));
-            g.fillPath (p);
+        for (auto& t : triangle)
+        {
+            auto* pixel = (juce::PixelARGB*) (pixels.data + t.offset);
 
-            g.setColour (juce::Colours::black.withAlpha (0.75f));
-            g.strokePath (p, juce::PathStrokeType (1.2f));
+            pixel->setARGB (t.alpha,
+                            juce::uint8 ((t.hueWeight * rgb.r + t.whiteWeight) * 255.0f),
+                            juce::uint8 ((t.hueWeight * rgb.g + t.whiteWeight) * 255.0f),
+                            juce::uint8 ((t.hueWeight * rgb.b + t.whiteWeight) * 255.0f));
+            pixel->premultiply();
         }
-    };
-
-    Parameter1DMarker marker;
-    Params param = Params::hue;
+    }
 
-    JUCE_DECLARE_NON_COPYABLE (Parameter1D)
+    JUCE_DECLARE_NON_COPYABLE (HueWheel)
 };
 
 //==============================================================================
@@ -487,7 +1481,7 @@ public:
 
     void paint (juce::Graphics& g) override
     {
-        auto col = owner.getSwatchColour (index);
+        auto col = owner.getDisplayColour (owner.getSwatchColour (index));
 
         g.fillCheckerBoard (getLocalBounds().toFloat(), 6.0f, 6.0f,
                             juce::Colour (0xffdddddd).overlaidWith (col),
@@ -549,12 +1543,16 @@ public:
         {
             colourLabel.setEditable (true);
 
+            // hex digits, or a colour name such as "Rebecca Purple"
             colourLabel.onEditorShow = [this]
             {
                 if (auto* ed = colourLabel.getCurrentTextEditor())
-                    ed->setInputRestrictions ((owner.flags & showAlphaChannel) ? 8 : 6, "1234567890ABCDEFabcdef");
+                    ed->setInputRestrictions (NamedColours::maxNameLength + 4,
+                                              "1234567890ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz -_");
             };
 
+            // the name is only looked up once the edit ends, as a name can be the
+            // start of a longer one
             colourLabel.onEditorHide = [this]
             {
                 updateColourIfNecessary (colourLabel.getText());
@@ -564,7 +1562,8 @@ public:
         addAndMakeVisible (colourLabel);
     }
 
-    void updateIfNeeded()
+    /** Returns true if the colour shown changed. */
+    bool updateIfNeeded()
     {
         auto newColour = owner.getCurrentColour();
 
@@ -580,14 +1579,19 @@ public:
             labelWidth = juce::GlyphArrangement::getStringWidthInt ( labelFont, colourLabel.getText () );
 
             repaint();
+            return true;
         }
+
+        return false;
     }
 
     void paint (juce::Graphics& g) override
     {
+        auto shown = owner.getDisplayColour (currentColour);
+
         g.fillCheckerBoard (getLocalBounds().toFloat(), 10.0f, 10.0f,
-                            juce::Colour (0xffdddddd).overlaidWith (currentColour),
-                            juce::Colour (0xffffffff).overlaidWith (currentColour));
+                            juce::Colour (0xffdddddd).overlaidWith (shown),
+                            juce::Colour (0xffffffff).overlaidWith (shown));
     }
 
     void resized() override
@@ -598,7 +1602,7 @@ public:
 private:
     void updateColourIfNecessary (const juce::String& newColourString)
     {
-        auto newColour = juce::Colour::fromString (newColourString);
+        auto newColour = NamedColours::find (newColourString).value_or (juce::Colour::fromString (newColourString));
 
         if (newColour != currentColour)
             owner.set (newColour);
@@ -609,7 +1613,7 @@ private:
     juce::Colour currentColour;
     juce::Font labelFont { juce::FontOptions ( 14.0f, juce::Font::bold ) };
     int labelWidth = 0;
-    juce::Label colourLabel;
+    ColourNameTooltip<juce::Label> colourLabel { [this] { return DeepColour (currentColour); } };
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ColourPreviewComp)
 };
@@ -618,12 +1622,38 @@ private:
 ColourSelector::ColourSelector (int sectionsToShow, int edge, int gapAroundColourSpaceComponent)
     : colour (juce::Colours::white),
       flags (sectionsToShow),
-      edgeGap (edge)
+      edgeGap (edge),
+      colourSpaceGap (gapAroundColourSpaceComponent)
 {
-    setLookAndFeel (&lf);
+    setLookAndFeel (&lf.getObject());
 
     // not much point having a selector with no components in it!
-    jassert ((flags & (showColourAtTop | showRGBSliders | showHSBSliders | showColourspace)) != 0);
+    jassert ((flags & (showColourAtTop | showRGBSliders | showHSBSliders | showColourspace | showHueWheel)) != 0);
+
+    // the child components are created when the selector is first shown. Until
+    // then, the first toggle that will be shown is the active one, as it was
+    // when the toggles were created here
+    if ((flags & showToggle) != 0 && (flags & showHSBSliders) == 0 && (flags & showRGBSliders) != 0)
+        activeParam = Params::red;
+
+    model->addListener (this);
+    colourModelChanged (*model, juce::dontSendNotification);
+}
+
+ColourSelector::~ColourSelector()
+{
+    model->removeListener (this);
+    setLookAndFeel (nullptr);
+    dispatchPendingMessages();
+    swatchComponents.clear();
+}
+
+void ColourSelector::createComponents()
+{
+    if (componentsCreated)
+        return;
+
+    componentsCreated = true;
 
     if ((flags & showColourAtTop) != 0)
     {
@@ -633,9 +1663,9 @@ ColourSelector::ColourSelector (int sectionsToShow, int edge, int gapAroundColou
 
     if ((flags & showHSBSliders) != 0)
     {
-        sliders.add (hueSlider = new ColourComponentSlider (TRANS ("H"), 360));
-        sliders.add (saturationSlider = new ColourComponentSlider (TRANS ("S"), 100));
-        sliders.add (brightnessSlider = new ColourComponentSlider (TRANS ("B"), 100));
+        sliders.add (hueSlider = new ColourComponentSlider (TRANS ("H"), 360, Channel::hue));
+        sliders.add (saturationSlider = new ColourComponentSlider (TRANS ("S"), 100, Channel::saturation));
+        sliders.add (brightnessSlider = new ColourComponentSlider (TRANS ("B"), 100, Channel::brightness));
 
         if ((flags & showToggle) != 0)
         {
@@ -647,9 +1677,9 @@ ColourSelector::ColourSelector (int sectionsToShow, int edge, int gapAroundColou
     if ((flags & showRGBSliders) != 0)
     {
 
-        sliders.add (redSlider = new ColourComponentSlider (TRANS ("R"), 255));
-        sliders.add (greenSlider = new ColourComponentSlider (TRANS ("G"), 255));
-        sliders.add (blueSlider = new ColourComponentSlider (TRANS ("B"), 255));
+        sliders.add (redSlider = new ColourComponentSlider (TRANS ("R"), 255, Channel::red));
+        sliders.add (greenSlider = new ColourComponentSlider (TRANS ("G"), 255, Channel::green));
+        sliders.add (blueSlider = new ColourComponentSlider (TRANS ("B"), 255, Channel::blue));
 
         if ((flags & showToggle) != 0)
         {
@@ -660,12 +1690,12 @@ ColourSelector::ColourSelector (int sectionsToShow, int edge, int gapAroundColou
     }
 
     if ((flags & showAlphaChannel) != 0)
-        sliders.add (alphaSlider = new ColourComponentSlider (TRANS ("A"), 255));
+        sliders.add (alphaSlider = new ColourComponentSlider (TRANS ("A"), 255, Channel::alpha));
 
     for (auto& slider : sliders)
     {
         addAndMakeVisible (slider);
-        slider->onValueChange = [this, slider] { changeColour (slider); };
+        slider->onValueChange = [this, slider] { changeColour (*slider); };
     }
 
     for (auto& toggle : toggles)
@@ -673,16 +1703,28 @@ ColourSelector::ColourSelector (int sectionsToShow, int edge, int gapAroundColou
         addAndMakeVisible (toggle);
         toggle->setButtonText ({});
         toggle->setRadioGroupId (1);
-        toggle->onClick = [this] { updateParameters(); sendChangeMessage(); };
+        toggle->onClick = [this, toggle]
+        {
+            if (toggle->getToggleState())
+                activeParam = (Params) toggle->getName().getIntValue();
+
+            updateParameters();
+            sendChangeMessage();
+        };
     }
 
-    if (toggles.size() > 0)
-        toggles[0]->setToggleState (true, juce::dontSendNotification);
+    for (auto t : toggles)
+        t->setToggleState ((Params) t->getName().getIntValue() == activeParam, juce::dontSendNotification);
 
-    if ((flags & showColourspace) != 0)
+    if ((flags & showHueWheel) != 0)
     {
-        parameter2D.reset (new Parameter2D (*this, gapAroundColourSpaceComponent));
-        parameter1D.reset (new Parameter1D (*this, gapAroundColourSpaceComponent));
+        hueWheel.reset (new HueWheel (*this, colourSpaceGap));
+        addAndMakeVisible (hueWheel.get());
+    }
+    else if ((flags & showColourspace) != 0)
+    {
+        parameter2D.reset (new Parameter2D (*this, colourSpaceGap));
+        parameter1D.reset (new Parameter1D (*this, colourSpaceGap));
 
         addAndMakeVisible (parameter2D.get());
         addAndMakeVisible (parameter1D.get());
@@ -690,31 +1732,18 @@ ColourSelector::ColourSelector (int sectionsToShow, int edge, int gapAroundColou
 
     if ((flags & showHexEdit) != 0)
     {
-        hex = std::make_unique<juce::TextEditor>();
+        hex = std::make_unique<ColourNameTooltip<juce::TextEditor>> ([this] { return colour; });
         hex->setJustification (juce::Justification::centred);
-        hex->onTextChange = [this]
-        {
-            auto hcol = hex->getText();
-
-            // convert hex3 and hex4 formats to hex6 and hex8
-            if ( hcol.length () == 3 )
-                hcol = juce::String::formatted ( "%c%c%c%c%c%c", hcol[ 0 ], hcol[ 0 ], hcol[ 1 ], hcol[ 1 ], hcol[ 2 ], hcol[ 2 ] );
-            else if ( hcol.length () == 4 )
-                hcol = juce::String::formatted ( "%c%c%c%c%c%c%c%c", hcol[ 0 ], hcol[ 0 ], hcol[ 1 ], hcol[ 1 ], hcol[ 2 ], hcol[ 2 ], hcol[ 3 ], hcol[ 3 ] );
-
-            // Add missing alpha
-            if ( hcol.length () == 6 )
-                hcol += juce::String ( "ff" );
-
-            // Convert rgba to argb (JUCE is weird)
-            if ( hcol.length () == 8 )
-            {
-                colour = juce::Colour::fromString (hcol.substring (6) + hcol.substring (0, 6));
-                update (juce::sendNotification);
-            }
-        };
+        // complete hex colours are taken as they are typed. A name can be the start
+        // of a longer one, such as "gold" of "goldenrod", so names wait for the edit to end.
+        hex->onTextChange = [this] { setColourFromHexText (false); };
+        hex->onReturnKey = [this] { setColourFromHexText (true); };
         hex->onFocusLost = [this]
         {
+            setColourFromHexText (true);
+
+            // the text may have been edited without changing the colour
+            shownHexColour.reset();
             update (juce::sendNotification);
         };
         addAndMakeVisible (*hex);
@@ -738,13 +1767,56 @@ ColourSelector::ColourSelector (int sectionsToShow, int edge, int gapAroundColou
 
     update (juce::dontSendNotification);
     updateParameters();
+    resized();
 }
 
-ColourSelector::~ColourSelector()
+void ColourSelector::setColourFromHexText (bool acceptNames)
 {
-    setLookAndFeel (nullptr);
-    dispatchPendingMessages();
-    swatchComponents.clear();
+    auto hcol = hex->getText().trim();
+
+    if (acceptNames)
+    {
+        if (auto named = NamedColours::find (hcol))
+        {
+            set (DeepColour (*named));
+            return;
+        }
+    }
+
+    if (! hcol.containsOnly ("0123456789abcdefABCDEF"))
+        return;
+
+    // convert hex3 and hex4 formats to hex6 and hex8
+    if ( hcol.length () == 3 )
+        hcol = juce::String::formatted ( "%c%c%c%c%c%c", hcol[ 0 ], hcol[ 0 ], hcol[ 1 ], hcol[ 1 ], hcol[ 2 ], hcol[ 2 ] );
+    else if ( hcol.length () == 4 )
+        hcol = juce::String::formatted ( "%c%c%c%c%c%c%c%c", hcol[ 0 ], hcol[ 0 ], hcol[ 1 ], hcol[ 1 ], hcol[ 2 ], hcol[ 2 ], hcol[ 3 ], hcol[ 3 ] );
+
+    // Add missing alpha
+    if ( hcol.length () == 6 )
+        hcol += juce::String ( "ff" );
+
+    // Convert rgba to argb (JUCE is weird)
+    if ( hcol.length () == 8 )
+    {
+        set (DeepColour (juce::Colour::fromString (hcol.substring (6) + hcol.substring (0, 6))));
+    }
+}
+
+void ColourSelector::visibilityChanged()
+{
+    if (isShowing())
+        createComponents();
+    else
+        releaseCaches();
+}
+
+void ColourSelector::parentHierarchyChanged()
+{
+    if (isShowing())
+        createComponents();
+    else
+        releaseCaches();
 }
 
 //==============================================================================
@@ -755,52 +1827,73 @@ juce::Colour ColourSelector::getCurrentColour() const
 
 void ColourSelector::setCurrentColour (juce::Colour c, juce::NotificationType notification)
 {
-    if (DeepColour (c) != colour)
-    {
-        originalColour = c;
-        colour = ((flags & showAlphaChannel) != 0) ? c : c.withAlpha ((juce::uint8) 0xff);
-        update (notification);
-    }
+    setCurrentColour (DeepColour (c), notification);
 }
 
 void ColourSelector::setCurrentColour (DeepColour c, juce::NotificationType notification)
 {
     if (c != colour)
-    {
-        originalColour = c;
-        colour = ((flags & showAlphaChannel) != 0) ? c : c.withAlpha (1.0f);
-        update (notification);
-    }
+        model->setColourAndOriginal (c, c, notification);
 }
 
 void ColourSelector::set (const DeepColour& newColour)
 {
-    colour = newColour;
-    update (juce::sendNotification);
+    model->setColour (newColour, juce::sendNotification);
+}
+
+void ColourSelector::setModel (ColourModel* newModel)
+{
+    if (newModel == nullptr)
+        newModel = &ownModel;
+
+    if (newModel == model)
+        return;
+
+    model->removeListener (this);
+    model = newModel;
+    model->addListener (this);
+
+    colourModelChanged (*model, juce::sendNotification);
+}
+
+void ColourSelector::colourModelChanged (ColourModel& m, juce::NotificationType notification)
+{
+    // every view attached to the model gets here, so this selector may not be the one that changed it
+    colour = ((flags & showAlphaChannel) != 0) ? m.getColour() : m.getColour().withAlpha (1.0f);
+    originalColour = m.getOriginalColour();
+
+    update (notification);
 }
 
 //==============================================================================
 void ColourSelector::update (juce::NotificationType notification)
 {
-    if (hueSlider)
-    {
-        hueSlider->setValue (colour.getHue() * 360,                 juce::dontSendNotification);
-        saturationSlider->setValue (colour.getSaturation() * 100,   juce::dontSendNotification);
-        brightnessSlider->setValue (colour.getBrightness() * 100,   juce::dontSendNotification);
-    }
+    // the model converted the colour once for all the views showing it. Each
+    // widget is only touched if what it displays is going to change.
+    const auto& hsb = model->getHSB();
+    const auto rgb = getWorkingRGB();
 
-    if (redSlider)
-    {
-        redSlider->setValue (colour.getRed() * 255,     juce::dontSendNotification);
-        greenSlider->setValue (colour.getGreen() * 255, juce::dontSendNotification);
-        blueSlider->setValue (colour.getBlue() * 255,   juce::dontSendNotification);
-    }
+    // in the order of the Channel enum, so each slider looks its value up rather than testing flags
+    const float channels[] = { hsb.h, hsb.s, hsb.b, rgb.r, rgb.g, rgb.b, colour.getAlpha() };
+
+    ++updateStats.updates;
 
-    if (alphaSlider)
-        alphaSlider->setValue (colour.getAlpha() * 255, juce::dontSendNotification);
+    for (auto* slider : sliders)
+        showValue (*slider, channels[(int) slider->channel] * slider->getMaximum());
 
     if (hex && ! hex->hasKeyboardFocus (true))
-        hex->setText (colour.getColour().toDisplayString ((flags & showAlphaChannel) != 0), juce::dontSendNotification);
+    {
+        // the text is only formatted when the colour it shows changes, as that allocates
+        auto changed = shownHexColour != colour.getColour();
+
+        if (changed)
+        {
+            shownHexColour = colour.getColour();
+            hex->setText (shownHexColour->toDisplayString ((flags & showAlphaChannel) != 0), juce::dontSendNotification);
+        }
+
+        countUpdate (changed);
+    }
 
     if (parameter2D != nullptr)
     {
@@ -808,11 +1901,24 @@ void ColourSelector::update (juce::NotificationType notification)
         parameter1D->updateIfNeeded();
     }
 
+    if (hueWheel != nullptr)
+        hueWheel->updateIfNeeded();
+
     if (originalColourComponent != nullptr)
-        originalColourComponent->repaint();
+    {
+        auto changed = originalColour != shownOriginalColour;
+
+        if (changed)
+        {
+            shownOriginalColour = originalColour;
+            originalColourComponent->repaint();
+        }
+
+        countUpdate (changed);
+    }
 
     if (previewComponent != nullptr)
-        previewComponent->updateIfNeeded();
+        countUpdate (previewComponent->updateIfNeeded());
 
     if (notification != juce::dontSendNotification)
         sendChangeMessage();
@@ -824,6 +1930,11 @@ void ColourSelector::update (juce::NotificationType notification)
 //==============================================================================
 void ColourSelector::paint (juce::Graphics& g)
 {
+    // JUCE doesn't tell a component when an ancestor is shown, so a selector that
+    // started out in a hidden tab or panel first learns that it is on screen here
+    if (! componentsCreated && ! getLocalBounds().isEmpty())
+        createComponents();
+
     g.fillAll (findColour (backgroundColourId));
 
     if ((flags & showRGBSliders) != 0)
@@ -844,6 +1955,9 @@ void ColourSelector::paint (juce::Graphics& g)
 
 void ColourSelector::resized()
 {
+    if (! componentsCreated)
+        return;
+
     const int swatchesPerRow = 8;
     const int swatchHeight = 22;
 
@@ -859,7 +1973,14 @@ void ColourSelector::resized()
 
     int y = topSpace;
 
-    if ((flags & showColourspace) != 0)
+    if (hueWheel != nullptr)
+    {
+        hueWheel->setBounds (edgeGap, y, getWidth() - edgeGap * 2,
+                             getHeight() - topSpace - sliderSpace - swatchSpace - edgeGap);
+
+        y = getHeight() - sliderSpace - swatchSpace - edgeGap;
+    }
+    else if ((flags & showColourspace) != 0)
     {
         const int hueWidth = juce::jmin (50, proportionOfWidth (0.15f));
 
@@ -960,78 +2081,159 @@ void ColourSelector::resized()
     }
 }
 
-void ColourSelector::changeColour (juce::Slider* slider)
+void ColourSelector::changeColour (const ColourComponentSlider& slider)
 {
-    if (sliders[0] == nullptr)
-        return;
+    // update() leaves sliders alone while their displayed value is the same, so they
+    // can be slightly behind the model. Only the moved slider's value is taken.
+    auto value = float (slider.getValue() / slider.getMaximum());
+    auto alpha = colour.getAlpha();
 
-    if (hueSlider == slider || saturationSlider == slider || brightnessSlider == slider)
+    switch (slider.channel)
     {
-        auto col = DeepColour::fromHSB (float (hueSlider->getValue() / 360.0),
-                                        float (saturationSlider->getValue() / 100.0),
-                                        float (brightnessSlider->getValue() / 100.0),
-                                        float (alphaSlider ? alphaSlider->getValue() / 255.0 : 1.0));
+        case Channel::alpha:
+        {
+            set (colour.withAlpha (value));
+            break;
+        }
+
+        case Channel::hue:
+        case Channel::saturation:
+        case Channel::brightness:
+        {
+            auto hsb = model->getHSB();
+
+            if (slider.channel == Channel::hue)             hsb.h = value;
+            else if (slider.channel == Channel::saturation) hsb.s = value;
+            else                                            hsb.b = value;
+
+            set (DeepColour::fromHSB (hsb.h, hsb.s, hsb.b, alpha));
+            break;
+        }
+
+        case Channel::red:
+        case Channel::green:
+        case Channel::blue:
+        {
+            auto rgb = getWorkingRGB();
 
-        set (col);
+            if (slider.channel == Channel::red)             rgb.r = value;
+            else if (slider.channel == Channel::green)      rgb.g = value;
+            else                                            rgb.b = value;
+
+            set (DeepColour::fromRGB (rgb, workingSpace, alpha));
+            break;
+        }
     }
+}
+
+void ColourSelector::showValue (juce::Slider& slider, double value)
+{
+    // the sliders display whole numbers, so smaller changes aren't visible
+    auto changed = (int) slider.getValue() != (int) value;
+
+    if (changed)
+        slider.setValue (value, juce::dontSendNotification);
+
+    countUpdate (changed);
+}
+
+void ColourSelector::countUpdate (bool refreshed) noexcept
+{
+    if (refreshed)
+        ++updateStats.refreshed;
     else
-    {
-        auto col = DeepColour::fromRGBA (float (redSlider->getValue() / 255.0),
-                                         float (greenSlider->getValue() / 255.0),
-                                         float (blueSlider->getValue() / 255.0),
-                                         float (alphaSlider ? alphaSlider->getValue() / 255.0 : 1.0));
+        ++updateStats.skipped;
+}
 
-        set (col);
-    }
+ColourSelector::UpdateStats ColourSelector::getUpdateStats() const noexcept
+{
+    // every render is measured by a governor, wherever it ran
+    auto stats = updateStats;
+    stats.renders = getNumRenders() - rendersAtReset;
+    return stats;
+}
+
+void ColourSelector::resetUpdateStats() noexcept
+{
+    updateStats = {};
+    rendersAtReset = getNumRenders();
+}
+
+juce::int64 ColourSelector::getNumRenders() const noexcept
+{
+    return planeGovernor->getNumMeasurements() + stripGovernor->getNumMeasurements();
+}
+
+/** Returns true while the user is dragging somewhere in the selector. */
+bool ColourSelector::isDragging() const
+{
+    return playingDrag || isMouseButtonDown (true);
+}
+
+/** Returns how urgently the selector needs its images. They are only requested
+    when a part is painted, so a selector that asks is always on screen.
+*/
+RenderScheduler::Priority ColourSelector::getRenderPriority() const
+{
+    return isDragging() || hasKeyboardFocus (true) ? RenderScheduler::Priority::interacting
+                                                   : RenderScheduler::Priority::visible;
 }
 
 void ColourSelector::updateParameters()
 {
+    if (parameter2D == nullptr)
+        return;
+
     auto state = getActiveParam();
+    auto [x, y] = getPlaneAxes (state);
 
-    if (state == Params::hue)
-    {
-        parameter1D->setParameter (Params::hue);
-        parameter2D->setParameters (Params::saturation, Params::brightness);
-    }
-    else if (state == Params::saturation)
-    {
-        parameter1D->setParameter (Params::saturation);
-        parameter2D->setParameters (Params::hue, Params::brightness);
-    }
-    else if (state == Params::brightness)
-    {
-        parameter1D->setParameter (Params::brightness);
-        parameter2D->setParameters (Params::hue, Params::saturation);
-    }
-    else if (state == Params::red)
-    {
-        parameter1D->setParameter (Params::red);
-        parameter2D->setParameters (Params::blue, Params::green);
-    }
-    else if (state == Params::green)
-    {
-        parameter1D->setParameter (Params::green);
-        parameter2D->setParameters (Params::blue, Params::red);
-    }
-    else if (state == Params::blue)
+    parameter1D->setParameter (state);
+    parameter2D->setParameters (x, y);
+}
+
+std::pair<ColourSelector::Params, ColourSelector::Params> ColourSelector::getPlaneAxes (Params activeParam) noexcept
+{
+    switch (activeParam)
     {
-        parameter1D->setParameter (Params::blue);
-        parameter2D->setParameters (Params::red, Params::green);
+        case Params::hue:           return { Params::saturation, Params::brightness };
+        case Params::saturation:    return { Params::hue, Params::brightness };
+        case Params::brightness:    return { Params::hue, Params::saturation };
+        case Params::red:           return { Params::blue, Params::green };
+        case Params::green:         return { Params::blue, Params::red };
+        case Params::blue:          return { Params::red, Params::green };
+        default:                    break;
     }
+
+    jassertfalse;
+    return { Params::saturation, Params::brightness };
 }
 
-ColourSelector::Params ColourSelector::getActiveParam ()
+juce::Image ColourSelector::renderPlane (juce::Point<int> size, const DeepColour& colour, Params activeParam, WorkingSpace space)
 {
-    for (auto t : toggles)
-        if (t->getToggleState())
-            return (Params) t->getName().getIntValue();
+    RenderQualityGovernor governor;
+    RasterPool pool;
+    auto [x, y] = getPlaneAxes (activeParam);
+
+    return Parameter2D::createImage (size, 1.0f, governor, pool, colour, x, y, space, -1.0f, nullptr);
+}
+
+juce::Image ColourSelector::renderStrip (juce::Point<int> size, const DeepColour& colour, Params activeParam, WorkingSpace space)
+{
+    RenderQualityGovernor governor;
+    RasterPool pool;
 
-    return Params::hue;
+    return Parameter1D::createImage (size, 1.0f, governor, pool, colour, activeParam, space);
+}
+
+ColourSelector::Params ColourSelector::getActiveParam ()
+{
+    return activeParam;
 }
 
 void ColourSelector::setActiveParam ( Params p )
 {
+    activeParam = p;
+
     for (auto t : toggles)
         t->setToggleState ((Params) t->getName().getIntValue() == p, juce::dontSendNotification);
 
@@ -1055,4 +2257,117 @@ void ColourSelector::setSwatchColour (int, const juce::Colour&)
     jassertfalse; // if you've overridden getNumSwatches(), you also need to implement this method
 }
 
+void ColourSelector::setSwatchesFromImage (const juce::Image& image)
+{
+    PaletteExtractor::Options options;
+    options.numColours = getNumSwatches();
+
+    if (options.numColours <= 0)
+        return;
+
+    auto palette = PaletteExtractor::extract (image, options);
+
+    for (auto [i, entry] : juce::enumerate (palette))
+        setSwatchColour (int (i), entry.colour.getColour());
+
+    for (auto* sc : swatchComponents)
+        sc->repaint();
+}
+
+//==============================================================================
+void ColourSelector::setRenderQuality (const RenderQualityGovernor::Settings& settings)
+{
+    planeGovernor->setSettings (settings);
+    stripGovernor->setSettings (settings);
+
+    if (parameter2D != nullptr)
+        parameter2D->updateIfNeeded();
+
+    if (parameter1D != nullptr)
+        parameter1D->updateIfNeeded();
+}
+
+RenderQualityGovernor::Settings ColourSelector::getRenderQuality() const
+{
+    return planeGovernor->getSettings();
+}
+
+//==============================================================================
+void ColourSelector::setContrastReference (std::optional<DeepColour> reference)
+{
+    if (reference == contrastReference)
+        return;
+
+    contrastReference = reference;
+
+    if (parameter2D != nullptr)
+        parameter2D->updateIfNeeded();
+}
+
+void ColourSelector::setDensityImage (const juce::Image& image)
+{
+    if (image.isValid())
+        densityHistogram = std::make_shared<const ColourHistogram> (image);
+    else
+        densityHistogram = nullptr;
+
+    ++densityGeneration;
+
+    if (parameter2D != nullptr)
+        parameter2D->updateIfNeeded();
+}
+
+void ColourSelector::setColourVisionSimulation (ColourVision::Deficiency deficiency)
+{
+    if (deficiency == colourVision)
+        return;
+
+    colourVision = deficiency;
+    repaint();
+}
+
+juce::Colour ColourSelector::getDisplayColour (juce::Colour c) const noexcept
+{
+    return ColourVision::simulate (c, colourVision);
+}
+
+void ColourSelector::setWorkingSpace (WorkingSpace space)
+{
+    if (space == workingSpace)
+        return;
+
+    workingSpace = space;
+
+    // the images are keyed by the space, so the RGB ones are rendered again
+    update (juce::dontSendNotification);
+}
+
+RGB ColourSelector::getWorkingRGB() const noexcept
+{
+    // the model's RGB values are sRGB, converted once when the colour was set
+    return convertRGB (model->getRGB(), WorkingSpace::sRGB, workingSpace);
+}
+
+void ColourSelector::releaseCaches()
+{
+    if (parameter2D != nullptr)
+        parameter2D->releaseCache();
+
+    if (parameter1D != nullptr)
+        parameter1D->releaseCache();
+
+    if (hueWheel != nullptr)
+        hueWheel->releaseCache();
+}
+
+void ColourSelector::releaseAllCaches()
+{
+    juce::SharedResourcePointer<RasterCache>()->releaseAll();
+}
+
+size_t ColourSelector::getTotalCacheBytes()
+{
+    return juce::SharedResourcePointer<RasterCache>()->getTotalBytes();
+}
+
 } // namespace juce
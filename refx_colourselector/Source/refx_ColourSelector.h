@@ -12,10 +12,14 @@ namespace reFX
     This class is also a ChangeBroadcaster, so listeners can register to be told
     when the colour changes.
 
+    The colour is kept in a ColourModel. Several selectors, and other views, can
+    share one model with setModel() to show and edit the same colour.
+
     @tags{GUI}
 */
 class ColourSelector : public juce::Component,
-                       public juce::ChangeBroadcaster
+                       public juce::ChangeBroadcaster,
+                       private ColourModel::Listener
 {
 public:
     //==============================================================================
@@ -24,7 +28,7 @@ public:
     {
         showAlphaChannel    = 1 << 0,           /**< if set, the colour's alpha channel can be changed as well as its RGB. */
         showColourAtTop     = 1 << 1,           /**< if set, a swatch of the colour is shown at the top of the component. */
-        editableColour      = 1 << 2,           /**< if set, the colour shows at the top of the component is editable. */
+        editableColour      = 1 << 2,           /**< if set, the colour shows at the top of the component is editable, as hex or as a CSS colour name. */
         showRGBSliders      = 1 << 3,           /**< if set, RGB sliders are shown at the bottom of the component. */
         showSliders         = showRGBSliders,   /**< if set, RGB sliders are shown at the bottom of the component. */
         showHSBSliders      = 1 << 4,           /**< if set, HSV sliders are shown at the bottom of the component. */
@@ -32,7 +36,8 @@ public:
         showReset           = 1 << 6,           /**< if set, show a button to reset colour. */
         showOriginalColour  = 1 << 7,           /**< if set, show a swatch with original colour and current. */
         showColourspace     = 1 << 8,           /**< if set, a big HSV selector is shown. */
-        showHexEdit         = 1 << 9,           /**< if set, a TextEditor with the colour in hex is shown **/
+        showHexEdit         = 1 << 9,           /**< if set, a TextEditor with the colour in hex is shown. It also accepts CSS colour names. **/
+        showHueWheel        = 1 << 10,          /**< if set, a hue ring around a saturation and brightness triangle is shown, instead of the colourspace. */
     };
 
     //==============================================================================
@@ -45,6 +50,10 @@ public:
 
         gapAroundColourSpaceComponent indicates how much of a gap to put around the
         colourspace and hue selector components.
+
+        The sliders, editors and colourspace are only created when the selector is
+        first shown or painted, so hidden selectors are cheap. All selectors share
+        one ColourSelectorLF.
     */
     ColourSelector (int flags = (showAlphaChannel | showColourAtTop | showRGBSliders | showColourspace),
                     int edgeGap = 4,
@@ -79,6 +88,9 @@ public:
     */
     void setCurrentColour (DeepColour newColour, juce::NotificationType notificationType = juce::sendNotification);
 
+    /** Returns the ColourSelectorOptions flags that the selector was created with. */
+    int getFlags() const noexcept                       { return flags; }
+
     enum class Params
     {
         hue,
@@ -94,6 +106,34 @@ public:
 
     void setActiveParam ( Params );
 
+    /** Returns the parameters on the x and y axes of the colour plane while a
+        parameter is active. The strip shows the active parameter itself.
+    */
+    static std::pair<Params, Params> getPlaneAxes (Params activeParam) noexcept;
+
+    /** Renders the image of the colour plane for an active parameter, as a selector
+        does at full quality, without the contrast lines or the density.
+
+        This is the code the selectors use, so it can be checked and timed without one.
+    */
+    static juce::Image renderPlane (juce::Point<int> size, const DeepColour& colour, Params activeParam,
+                                    WorkingSpace space = WorkingSpace::sRGB);
+
+    /** Renders the image of the strip for an active parameter, as a selector does at full quality. */
+    static juce::Image renderStrip (juce::Point<int> size, const DeepColour& colour, Params activeParam,
+                                    WorkingSpace space = WorkingSpace::sRGB);
+
+    //==============================================================================
+    /** Makes this selector show and edit the colour of another model.
+
+        The model must outlive the selector, or be detached first. Pass nullptr to
+        go back to the selector's own model.
+    */
+    void setModel (ColourModel* newModel);
+
+    /** Returns the model holding the colour this selector shows. */
+    ColourModel& getModel() noexcept        { return *model; }
+
     //==============================================================================
     /** Tells the selector how many preset colour swatches you want to have on the component.
 
@@ -123,6 +163,117 @@ public:
     */
     virtual void setSwatchColour (int index, const juce::Colour& newColour);
 
+    /** Replaces the swatch colours with the dominant colours of an image.
+
+        This calls setSwatchColour() with the colours found by a PaletteExtractor,
+        ordered by how much of the image they cover. An image with fewer distinct
+        colours than there are swatches only replaces the first ones, and the
+        rest keep their colours.
+    */
+    void setSwatchesFromImage (const juce::Image& image);
+
+    //==============================================================================
+    /** Sets how the colour plane and strips trade resolution for speed.
+
+        While the user drags, they are rendered at the resolution that fits within
+        the frame budget, based on how long earlier renders took. Once the input has
+        been idle, they are rendered again at the maximum quality.
+    */
+    void setRenderQuality (const RenderQualityGovernor::Settings& settings);
+
+    /** Returns the settings used to choose the rendering resolution. */
+    RenderQualityGovernor::Settings getRenderQuality() const;
+
+    //==============================================================================
+    /** Shows where the colour plane reaches the WCAG contrast ratios of 3:1, 4.5:1
+        and 7:1 against a reference colour, such as the background behind a label.
+
+        The lines are drawn into the plane's image, so they are only computed when it
+        is rendered. Pass std::nullopt to hide them.
+    */
+    void setContrastReference (std::optional<DeepColour> reference);
+
+    /** Returns the colour the contrast lines are measured against, if they are shown. */
+    std::optional<DeepColour> getContrastReference() const     { return contrastReference; }
+
+    /** Shows where the colours of an image fall on the colour plane, by dimming the
+        areas that hold few or none of them.
+
+        Only the image's colours near the plane's fixed component are counted, as
+        the others aren't on the plane. The image is binned once into a
+        ColourHistogram, so changing the plane's axes or its fixed component only
+        projects the histogram again. Pass a null image to hide the density.
+    */
+    void setDensityImage (const juce::Image& image);
+
+    /** Shows everything the selector draws as it looks with a colour vision deficiency.
+
+        The simulation is applied to the cached images of the plane and the strip, and
+        to the colours of the swatches and previews, when they are drawn. So it can be
+        switched on and off without rendering anything again. The colour itself isn't
+        changed.
+    */
+    void setColourVisionSimulation (ColourVision::Deficiency deficiency);
+
+    /** Returns the deficiency being simulated. */
+    ColourVision::Deficiency getColourVisionSimulation() const noexcept     { return colourVision; }
+
+    /** Sets the space that the red, green and blue sliders and planes work in.
+
+        In linear sRGB, the values are proportional to light. In Display P3, the
+        planes and sliders cover the wider gamut, and the colours that sRGB can't
+        show are drawn clipped. Hue, saturation and brightness, and the hex text,
+        always use sRGB.
+
+        The colour is kept unclipped, so the red, green and blue sliders and planes
+        show where it really is in the working space. Hue, saturation, brightness and
+        the hex text show it clipped to the sRGB gamut.
+    */
+    void setWorkingSpace (WorkingSpace space);
+
+    /** Returns the space that the red, green and blue sliders and planes work in. */
+    WorkingSpace getWorkingSpace() const noexcept           { return workingSpace; }
+
+    //==============================================================================
+    /** Creates the sliders, editors and colourspace now.
+
+        They are otherwise created when the selector is first shown or painted. Call
+        this for a selector that will be shown right away, to move the work out of
+        its first paint.
+    */
+    void createComponents();
+
+    /** Drops the images this selector has cached. They are rendered again when next painted.
+
+        This happens automatically when the selector is hidden.
+    */
+    void releaseCaches();
+
+    /** Drops the images cached by every selector, for example when the system is low on memory. */
+    static void releaseAllCaches();
+
+    /** Returns the number of bytes used by the images cached by every selector and gradient editor. */
+    static size_t getTotalCacheBytes();
+
+    //==============================================================================
+    /** Counts the widgets that changes of colour refreshed, and those that were left
+        alone because they already displayed the new value.
+
+        It also counts how often the widgets were brought up to date, and how many
+        images of the plane and strip were rendered, including the background renders
+        whose results were dropped because a newer one had been requested.
+    */
+    struct UpdateStats
+    {
+        juce::int64 refreshed = 0;
+        juce::int64 skipped = 0;
+        juce::int64 updates = 0;
+        juce::int64 renders = 0;
+    };
+
+    UpdateStats getUpdateStats() const noexcept;
+    void resetUpdateStats() noexcept;
+
 
     //==============================================================================
     /** A set of colour IDs to use to change the colour of various aspects of the keyboard.
@@ -145,17 +296,46 @@ private:
     class SwatchComponent;
     class Parameter2D;
     class Parameter1D;
+    class HueWheel;
     class ColourPreviewComp;
     class OriginalColourComp;
+    class ColourComponentSlider;
 
-    ColourSelectorLF lf;
+    // what a slider shows and edits: the channel of one of the Params, or the alpha
+    enum class Channel
+    {
+        hue,
+        saturation,
+        brightness,
+
+        red,
+        green,
+        blue,
+
+        alpha
+    };
+
+    friend class DragTrace;
+
+    juce::SharedResourcePointer<ColourSelectorLF> lf;
+    ColourModel ownModel;
+    ColourModel* model = &ownModel;
+
+    // this view's copies of the model's colours, with the alpha removed if it isn't shown
     DeepColour colour;
     DeepColour originalColour;
 
+    // shared with the background render jobs, which can outlive the selector. The
+    // plane converts every pixel, while the strip is baked from a gradient, so each
+    // has its own estimate of the cost per pixel.
+    std::shared_ptr<RenderQualityGovernor> planeGovernor = std::make_shared<RenderQualityGovernor>();
+    std::shared_ptr<RenderQualityGovernor> stripGovernor = std::make_shared<RenderQualityGovernor>();
+
     juce::OwnedArray<juce::ToggleButton> toggles;
-    juce::OwnedArray<juce::Slider> sliders;
+    juce::OwnedArray<ColourComponentSlider> sliders;
     std::unique_ptr<Parameter2D> parameter2D;
     std::unique_ptr<Parameter1D> parameter1D;
+    std::unique_ptr<HueWheel> hueWheel;
     std::unique_ptr<juce::TextEditor> hex;
     std::unique_ptr<ColourPreviewComp> previewComponent;
     std::unique_ptr<OriginalColourComp> originalColourComponent;
@@ -163,6 +343,27 @@ private:
     juce::OwnedArray<SwatchComponent> swatchComponents;
     const int flags;
     int edgeGap;
+    const int colourSpaceGap;
+    bool componentsCreated = false;
+    Params activeParam = Params::hue;
+
+    std::optional<DeepColour> contrastReference;
+    ColourVision::Deficiency colourVision = ColourVision::Deficiency::none;
+    WorkingSpace workingSpace = WorkingSpace::sRGB;
+
+    // shared with the render jobs, and never changed once built
+    std::shared_ptr<const ColourHistogram> densityHistogram;
+    int densityGeneration = 0;
+
+    // the original colour the swatch was last painted with, and the colour in the hex editor
+    DeepColour shownOriginalColour;
+    std::optional<juce::Colour> shownHexColour;
+    UpdateStats updateStats;
+    juce::int64 rendersAtReset = 0;
+
+    // set while a DragTrace::Player drives the selector, which may not be showing
+    bool playingTrace = false;
+    bool playingDrag = false;
 
     juce::Slider* redSlider = nullptr;
     juce::Slider* greenSlider = nullptr;
@@ -172,13 +373,24 @@ private:
     juce::Slider* brightnessSlider = nullptr;
     juce::Slider* alphaSlider = nullptr;
 
+    void setColourFromHexText (bool acceptNames);
     void updateParameters();
     void update (juce::NotificationType);
-    void changeColour (juce::Slider*);
+    void changeColour (const ColourComponentSlider&);
+    void showValue (juce::Slider&, double value);
+    void countUpdate (bool refreshed) noexcept;
+    juce::int64 getNumRenders() const noexcept;
+    bool isDragging() const;
+    RenderScheduler::Priority getRenderPriority() const;
     void paint (juce::Graphics&) override;
     void resized() override;
+    void visibilityChanged() override;
+    void parentHierarchyChanged() override;
 
     void set (const DeepColour&);
+    juce::Colour getDisplayColour (juce::Colour) const noexcept;
+    RGB getWorkingRGB() const noexcept;
+    void colourModelChanged (ColourModel&, juce::NotificationType) override;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ColourSelector)
 };
@@ -0,0 +1,160 @@
+namespace reFX
+{
+
+//==============================================================================
+namespace
+{
+    using DeficiencyMatrix = std::array<float, 9>;
+
+    /** The matrices for linear RGB, by Deficiency. */
+    const DeficiencyMatrix& getDeficiencyMatrix (ColourVision::Deficiency deficiency) noexcept
+    {
+        static const DeficiencyMatrix matrices[] =
+        {
+            { 1.0f, 0.0f, 0.0f,
+              0.0f, 1.0f, 0.0f,
+              0.0f, 0.0f, 1.0f },
+
+            { 0.152286f, 1.052583f, -0.204868f,
+              0.114503f, 0.786281f,  0.099216f,
+             -0.003882f,-0.048116f,  1.051998f },
+
+            { 0.367322f, 0.860646f, -0.227968f,
+              0.280085f, 0.672501f,  0.047413f,
+             -0.011820f, 0.042940f,  0.968881f },
+
+            { 1.255528f,-0.076749f, -0.178779f,
+             -0.078411f, 0.930809f,  0.147602f,
+              0.004733f, 0.691367f,  0.303900f },
+        };
+
+        return matrices[(int) deficiency];
+    }
+
+    /** Encodes linear light as an 8-bit sRGB value, through a table of 4096 steps. */
+    juce::uint8 linearToSrgb8 (float value) noexcept
+    {
+        static const auto table = []
+        {
+            std::array<juce::uint8, 4096> t;
+
+            for (size_t i = 0; i < t.size(); ++i)
+                t[i] = juce::uint8 (juce::roundToInt (linearToSrgb (float (i) / float (t.size() - 1)) * 255.0f));
+
+            return t;
+        }();
+
+        return table[(size_t) juce::jlimit (0, 4095, juce::roundToInt (value * 4095.0f))];
+    }
+}
+
+//==============================================================================
+DeepColour ColourVision::simulate (const DeepColour& colour, Deficiency deficiency) noexcept
+{
+    if (deficiency == Deficiency::none)
+        return colour;
+
+    auto rgb = colour.getRGB();
+    auto r = srgbToLinear (rgb.r);
+    auto g = srgbToLinear (rgb.g);
+    auto b = srgbToLinear (rgb.b);
+
+    simulateLinear (&r, &g, &b, 1, deficiency);
+
+    return DeepColour::fromRGBA (linearToSrgb (juce::jlimit (0.0f, 1.0f, r)),
+                                 linearToSrgb (juce::jlimit (0.0f, 1.0f, g)),
+                                 linearToSrgb (juce::jlimit (0.0f, 1.0f, b)),
+                                 colour.getAlpha());
+}
+
+juce::Colour ColourVision::simulate (juce::Colour colour, Deficiency deficiency) noexcept
+{
+    if (deficiency == Deficiency::none)
+        return colour;
+
+    auto r = srgb8ToLinear (colour.getRed());
+    auto g = srgb8ToLinear (colour.getGreen());
+    auto b = srgb8ToLinear (colour.getBlue());
+
+    simulateLinear (&r, &g, &b, 1, deficiency);
+
+    return juce::Colour (linearToSrgb8 (r), linearToSrgb8 (g), linearToSrgb8 (b), colour.getAlpha());
+}
+
+void ColourVision::simulateLinear (float* red, float* green, float* blue, int num, Deficiency deficiency) noexcept
+{
+    const auto& m = getDeficiencyMatrix (deficiency);
+
+    for (int i = 0; i < num; ++i)
+    {
+        auto r = red[i];
+        auto g = green[i];
+        auto b = blue[i];
+
+        red[i]   = m[0] * r + m[1] * g + m[2] * b;
+        green[i] = m[3] * r + m[4] * g + m[5] * b;
+        blue[i]  = m[6] * r + m[7] * g + m[8] * b;
+    }
+}
+
+void ColourVision::simulate (const juce::Image& source, juce::Image& destination, Deficiency deficiency)
+{
+    jassert (source.getFormat() == destination.getFormat()
+              && source.getWidth() == destination.getWidth() && source.getHeight() == destination.getHeight());
+
+    auto width = source.getWidth();
+    auto height = source.getHeight();
+    auto hasAlpha = source.getFormat() == juce::Image::ARGB;
+
+    // kept by each thread, so that this doesn't allocate once warmed up
+    thread_local std::vector<float> channels;
+    channels.resize ((size_t) width * 3);
+
+    auto* r = channels.data();
+    auto* g = r + width;
+    auto* b = g + width;
+
+    const juce::Image::BitmapData in (source, juce::Image::BitmapData::readOnly);
+    juce::Image::BitmapData out (destination, juce::Image::BitmapData::writeOnly);
+
+    for (int y = 0; y < height; ++y)
+    {
+        auto* src = in.getLinePointer (y);
+        auto* dst = out.getLinePointer (y);
+
+        for (int x = 0; x < width; ++x)
+        {
+            juce::PixelARGB p;
+
+            // premultiplied pixels are simulated as the colour they cover with
+            if (hasAlpha)
+                p = ((const juce::PixelARGB*) (src + x * in.pixelStride))->getUnpremultiplied();
+            else
+                p.set (*(const juce::PixelRGB*) (src + x * in.pixelStride));
+
+            r[x] = srgb8ToLinear (p.getRed());
+            g[x] = srgb8ToLinear (p.getGreen());
+            b[x] = srgb8ToLinear (p.getBlue());
+        }
+
+        simulateLinear (r, g, b, width, deficiency);
+
+        for (int x = 0; x < width; ++x)
+        {
+            if (hasAlpha)
+            {
+                auto* s = (const juce::PixelARGB*) (src + x * in.pixelStride);
+                auto* d = (juce::PixelARGB*) (dst + x * out.pixelStride);
+                d->setARGB (s->getAlpha(), linearToSrgb8 (r[x]), linearToSrgb8 (g[x]), linearToSrgb8 (b[x]));
+                d->premultiply();
+            }
+            else
+            {
+                auto* d = (juce::PixelRGB*) (dst + x * out.pixelStride);
+                d->setARGB (255, linearToSrgb8 (r[x]), linearToSrgb8 (g[x]), linearToSrgb8 (b[x]));
+            }
+        }
+    }
+}
+
+} // namespace reFX
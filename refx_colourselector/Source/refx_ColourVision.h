@@ -0,0 +1,45 @@
+#pragma once
+
+namespace reFX
+{
+
+//==============================================================================
+/**
+    Simulates how colours look with a colour vision deficiency.
+
+    The colours are converted to linear light and transformed with the 3x3
+    matrices of Machado, Oliveira and Fernandes (2009), at full severity.
+
+    @tags{Graphics}
+*/
+class ColourVision
+{
+public:
+    //==============================================================================
+    enum class Deficiency
+    {
+        none,
+        protanopia,     /**< no long wavelength (red) cones */
+        deuteranopia,   /**< no medium wavelength (green) cones */
+        tritanopia,     /**< no short wavelength (blue) cones */
+    };
+
+    //==============================================================================
+    /** Returns how a colour looks with a deficiency. The alpha is kept. */
+    static DeepColour simulate (const DeepColour& colour, Deficiency deficiency) noexcept;
+
+    /** Returns how a colour looks with a deficiency. The alpha is kept. */
+    static juce::Colour simulate (juce::Colour colour, Deficiency deficiency) noexcept;
+
+    /** Transforms linear light colours stored as separate channel arrays, in place.
+        The loop has no branches, so that the compiler can vectorise it.
+    */
+    static void simulateLinear (float* red, float* green, float* blue, int num, Deficiency deficiency) noexcept;
+
+    /** Writes how an RGB or ARGB image looks with a deficiency to another image of
+        the same format and size.
+    */
+    static void simulate (const juce::Image& source, juce::Image& destination, Deficiency deficiency);
+};
+
+} // namespace reFX
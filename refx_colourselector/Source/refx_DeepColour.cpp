@@ -1,20 +1,139 @@
 namespace reFX
 {
 
-HSB rgbToHsb (const RGB& rgb)
+namespace
 {
+    /** A transfer curve between 0 and 1, sampled at evenly spaced points and interpolated. */
+    class TransferTable
+    {
+    public:
+        TransferTable (float (*curve) (float) noexcept, [[maybe_unused]] float maxError)
+        {
+            for (size_t i = 0; i < values.size(); ++i)
+                values[i] = curve (float (i) / float (size));
+
+           #if JUCE_DEBUG
+            // the error bound that the fast functions promise, checked against the exact curve
+            constexpr int numSamples = 1 << 18;
+            auto worst = 0.0f;
+
+            for (int i = 0; i <= numSamples; ++i)
+            {
+                auto x = float (i) / float (numSamples);
+                worst = std::max (worst, std::abs (lookup (x) - curve (x)));
+            }
+
+            jassert (worst <= maxError);
+           #endif
+        }
+
+        /** Interpolates the curve, for values between 0 and 1. */
+        float lookup (float value) const noexcept
+        {
+            auto pos = value * float (size);
+            auto index = std::min (int (pos), size - 1);
+            auto fraction = pos - float (index);
+
+            return values[(size_t) index] + (values[(size_t) index + 1] - values[(size_t) index]) * fraction;
+        }
+
+    private:
+        static constexpr int size = 4096;
+        std::array<float, size + 1> values;
+    };
+
+    const TransferTable& getDecodeTable()
+    {
+        static const TransferTable table (srgbToLinear, 1.0e-6f);
+        return table;
+    }
+
+    const TransferTable& getEncodeTable()
+    {
+        static const TransferTable table (linearToSrgb, 5.0e-5f);
+        return table;
+    }
+
+    /** Applies a curve to any value, using the table for values between 0 and 1. */
+    inline float applyCurve (const TransferTable& table, float (*curve) (float) noexcept, float value) noexcept
+    {
+        if (value >= 0.0f && value <= 1.0f)
+            return table.lookup (value);
+
+        return value < 0.0f ? -curve (-value) : curve (value);
+    }
+
+    // linear light conversions between the sRGB and Display P3 primaries, both with a D65 white point
+    constexpr float srgbToP3[] = { 0.8224621f, 0.1775380f, 0.0000000f,
+                                   0.0331941f, 0.9668058f, 0.0000000f,
+                                   0.0170827f, 0.0723974f, 0.9105199f };
+
+    constexpr float p3ToSrgb[] = {  1.2249401f, -0.2249404f, 0.0000000f,
+                                   -0.0420569f,  1.0420571f, 0.0000000f,
+                                   -0.0196376f, -0.0786361f, 1.0982735f };
+
+    template <typename V>
+    void applyPrimaries (const float* m, V& r, V& g, V& b) noexcept
+    {
+        auto r2 = m[0] * r + m[1] * g + m[2] * b;
+        auto g2 = m[3] * r + m[4] * g + m[5] * b;
+        auto b2 = m[6] * r + m[7] * g + m[8] * b;
+
+        r = r2;
+        g = g2;
+        b = b2;
+    }
+
+    /** The exact sRGB curves in float or double, with the sign mirrored below 0. */
+    template <typename V>
+    V decodeSrgb (V value) noexcept
+    {
+        if (value < 0)
+            return -decodeSrgb (-value);
+
+        if (value <= V (0.04045))
+            return value / V (12.92);
+
+        return std::pow ((value + V (0.055)) / V (1.055), V (2.4));
+    }
+
+    template <typename V>
+    V encodeSrgb (V value) noexcept
+    {
+        if (value < 0)
+            return -encodeSrgb (-value);
+
+        if (value <= V (0.0031308))
+            return value * V (12.92);
+
+        return V (1.055) * std::pow (value, V (1) / V (2.4)) - V (0.055);
+    }
+}
+
+//==============================================================================
+template <typename T>
+BasicHSB<T> rgbToHsb (const BasicRGB<T>& in)
+{
+    using V = ColourValue<T>;
+
+    // colours from a wider working space can lie outside the sRGB gamut, where
+    // hue, saturation and brightness aren't defined, so they are clipped first
+    const BasicRGB<V> rgb (juce::jlimit (V (0), V (1), V (in.r)),
+                           juce::jlimit (V (0), V (1), V (in.g)),
+                           juce::jlimit (V (0), V (1), V (in.b)));
+
     auto maxVal = std::max ({rgb.r, rgb.g, rgb.b});
     auto minVal = std::min ({rgb.r, rgb.g, rgb.b});
     auto delta = maxVal - minVal;
 
-    auto h = 0.0f;
-    auto s = 0.0f;
+    V h = 0;
+    V s = 0;
     auto b = maxVal;
 
     if (delta == 0)
     {
-        h = 0.0f;
-        s = 0.0f;
+        h = 0;
+        s = 0;
     }
     else
     {
@@ -32,19 +151,23 @@ HSB rgbToHsb (const RGB& rgb)
             h += 360;
     }
 
-    return { h / 360.0f, s, b };
+    return { T (h / 360), T (s), T (b) };
 }
 
-RGB hsbToRgb (const HSB& hsb)
+template <typename T>
+BasicRGB<T> hsbToRgb (const BasicHSB<T>& in)
 {
-    auto h = hsb.h * 360.0f;
+    using V = ColourValue<T>;
+    const BasicHSB<V> hsb (in);
+
+    auto h = hsb.h * 360;
     auto c = hsb.b * hsb.s;
-    auto x = c * (1.0f - std::abs (std::fmod (h / 60, 2.0f) - 1.0f));
+    auto x = c * (1 - std::abs (std::fmod (h / 60, V (2)) - 1));
     auto m = hsb.b - c;
 
-    auto r = 0.0f;
-    auto g = 0.0f;
-    auto b = 0.0f;
+    V r = 0;
+    V g = 0;
+    V b = 0;
 
     if (h < 60)
     {
@@ -83,113 +206,432 @@ RGB hsbToRgb (const HSB& hsb)
         b = x;
     }
 
-    return { r + m, g + m, b + m };
+    return { T (r + m), T (g + m), T (b + m) };
+}
+
+//==============================================================================
+float srgbToLinear (float value) noexcept
+{
+    if (value <= 0.04045f)
+        return value / 12.92f;
+
+    return std::pow ((value + 0.055f) / 1.055f, 2.4f);
+}
+
+float linearToSrgb (float value) noexcept
+{
+    if (value <= 0.0031308f)
+        return value * 12.92f;
+
+    return 1.055f * std::pow (value, 1.0f / 2.4f) - 0.055f;
+}
+
+float srgb8ToLinear (juce::uint8 value) noexcept
+{
+    static const auto table = []
+    {
+        std::array<float, 256> t;
+
+        for (size_t i = 0; i < t.size(); ++i)
+            t[i] = srgbToLinear (float (i) / 255.0f);
+
+        return t;
+    }();
+
+    return table[value];
+}
+
+float srgbToLinearFast (float value) noexcept
+{
+    return applyCurve (getDecodeTable(), srgbToLinear, value);
+}
+
+float linearToSrgbFast (float value) noexcept
+{
+    return applyCurve (getEncodeTable(), linearToSrgb, value);
+}
+
+template <typename T>
+BasicRGB<T> convertRGB (const BasicRGB<T>& rgb, WorkingSpace source, WorkingSpace target) noexcept
+{
+    if (source == target)
+        return rgb;
+
+    using V = ColourValue<T>;
+
+    // a single colour uses the exact curves, so that converting it back and forth doesn't drift
+    V r (rgb.r);
+    V g (rgb.g);
+    V b (rgb.b);
+
+    if (source != WorkingSpace::linearSRGB)
+    {
+        r = decodeSrgb (r);
+        g = decodeSrgb (g);
+        b = decodeSrgb (b);
+    }
+
+    if (source == WorkingSpace::displayP3)
+        applyPrimaries (p3ToSrgb, r, g, b);
+
+    if (target == WorkingSpace::displayP3)
+        applyPrimaries (srgbToP3, r, g, b);
+
+    if (target != WorkingSpace::linearSRGB)
+    {
+        r = encodeSrgb (r);
+        g = encodeSrgb (g);
+        b = encodeSrgb (b);
+    }
+
+    return { T (r), T (g), T (b) };
+}
+
+OKLab rgbToOklab (const RGB& rgb) noexcept
+{
+    return linearRgbToOklab (srgbToLinear (rgb.r), srgbToLinear (rgb.g), srgbToLinear (rgb.b));
+}
+
+OKLab linearRgbToOklab (float r, float g, float b) noexcept
+{
+    auto l = std::cbrt (0.4122214708f * r + 0.5363325363f * g + 0.0514459929f * b);
+    auto m = std::cbrt (0.2119034982f * r + 0.6806995451f * g + 0.1073969566f * b);
+    auto s = std::cbrt (0.0883024619f * r + 0.2817188376f * g + 0.6299787005f * b);
+
+    return { 0.2104542553f * l + 0.7936177850f * m - 0.0040720468f * s,
+             1.9779984951f * l - 2.4285922050f * m + 0.4505937099f * s,
+             0.0259040371f * l + 0.7827717662f * m - 0.8086757660f * s };
+}
+
+RGB oklabToRgb (const OKLab& lab) noexcept
+{
+    auto r = lab.L;
+    auto g = lab.a;
+    auto b = lab.b;
+
+    oklabToLinearRgb (&r, &g, &b, 1);
+
+    auto toSrgb = [] (float v) { return juce::jlimit (0.0f, 1.0f, linearToSrgb (v)); };
+
+    return { toSrgb (r), toSrgb (g), toSrgb (b) };
+}
+
+CIELab rgbToLab (const RGB& rgb) noexcept
+{
+    return linearRgbToLab (srgbToLinear (rgb.r), srgbToLinear (rgb.g), srgbToLinear (rgb.b));
+}
+
+CIELab linearRgbToLab (float r, float g, float b) noexcept
+{
+    // XYZ relative to the D65 white point
+    auto x = (0.4124564f * r + 0.3575761f * g + 0.1804375f * b) / 0.95047f;
+    auto y = (0.2126729f * r + 0.7151522f * g + 0.0721750f * b);
+    auto z = (0.0193339f * r + 0.1191920f * g + 0.9503041f * b) / 1.08883f;
+
+    auto f = [] (float t)
+    {
+        constexpr auto epsilon = 216.0f / 24389.0f;
+        constexpr auto kappa = 24389.0f / 27.0f;
+
+        return t > epsilon ? std::cbrt (t) : (kappa * t + 16.0f) / 116.0f;
+    };
+
+    auto fx = f (x);
+    auto fy = f (y);
+    auto fz = f (z);
+
+    return { 116.0f * fy - 16.0f, 500.0f * (fx - fy), 200.0f * (fy - fz) };
+}
+
+//==============================================================================
+void rgbToHsb (float* c0, float* c1, float* c2, int num) noexcept
+{
+    for (int i = 0; i < num; ++i)
+    {
+        // clipped to the sRGB gamut, as in the scalar version
+        auto r = std::min (1.0f, std::max (0.0f, c0[i]));
+        auto g = std::min (1.0f, std::max (0.0f, c1[i]));
+        auto b = std::min (1.0f, std::max (0.0f, c2[i]));
+
+        auto maxVal = std::max (r, std::max (g, b));
+        auto minVal = std::min (r, std::min (g, b));
+        auto delta = maxVal - minVal;
+        auto safeDelta = delta > 0.0f ? delta : 1.0f;
+
+        auto hr = (g - b) / safeDelta;
+        auto hg = (b - r) / safeDelta + 2.0f;
+        auto hb = (r - g) / safeDelta + 4.0f;
+        hr = hr < 0.0f ? hr + 6.0f : hr;
+
+        auto h = maxVal == r ? hr : (maxVal == g ? hg : hb);
+
+        c0[i] = delta > 0.0f ? h / 6.0f : 0.0f;
+        c1[i] = delta > 0.0f ? delta / maxVal : 0.0f;
+        c2[i] = maxVal;
+    }
+}
+
+void hsbToRgb (float* c0, float* c1, float* c2, int num) noexcept
+{
+    for (int i = 0; i < num; ++i)
+    {
+        auto h6 = c0[i] * 6.0f;
+        auto chroma = c2[i] * c1[i];
+
+        auto channel = [&] (float n)
+        {
+            auto k = n + h6;
+            k -= 6.0f * std::floor (k / 6.0f);
+            return c2[i] - chroma * std::max (0.0f, std::min (std::min (k, 4.0f - k), 1.0f));
+        };
+
+        auto r = channel (5.0f);
+        auto g = channel (3.0f);
+        auto b = channel (1.0f);
+
+        c0[i] = r;
+        c1[i] = g;
+        c2[i] = b;
+    }
+}
+
+void srgbToLinear (float* values, int num) noexcept
+{
+    auto& table = getDecodeTable();
+
+    for (int i = 0; i < num; ++i)
+        values[i] = applyCurve (table, srgbToLinear, values[i]);
+}
+
+void linearToSrgb (float* values, int num) noexcept
+{
+    auto& table = getEncodeTable();
+
+    for (int i = 0; i < num; ++i)
+        values[i] = applyCurve (table, linearToSrgb, values[i]);
+}
+
+void convertRGB (float* r, float* g, float* b, int num, WorkingSpace source, WorkingSpace target) noexcept
+{
+    if (source == target)
+        return;
+
+    if (source != WorkingSpace::linearSRGB)
+    {
+        srgbToLinear (r, num);
+        srgbToLinear (g, num);
+        srgbToLinear (b, num);
+    }
+
+    if (source == WorkingSpace::displayP3)
+        for (int i = 0; i < num; ++i)
+            applyPrimaries (p3ToSrgb, r[i], g[i], b[i]);
+
+    if (target == WorkingSpace::displayP3)
+        for (int i = 0; i < num; ++i)
+            applyPrimaries (srgbToP3, r[i], g[i], b[i]);
+
+    if (target != WorkingSpace::linearSRGB)
+    {
+        linearToSrgb (r, num);
+        linearToSrgb (g, num);
+        linearToSrgb (b, num);
+    }
+}
+
+void linearRgbToOklab (float* c0, float* c1, float* c2, int num) noexcept
+{
+    for (int i = 0; i < num; ++i)
+    {
+        auto lab = linearRgbToOklab (c0[i], c1[i], c2[i]);
+        c0[i] = lab.L;
+        c1[i] = lab.a;
+        c2[i] = lab.b;
+    }
+}
+
+void oklabToLinearRgb (float* c0, float* c1, float* c2, int num) noexcept
+{
+    for (int i = 0; i < num; ++i)
+    {
+        auto l = c0[i] + 0.3963377774f * c1[i] + 0.2158037573f * c2[i];
+        auto m = c0[i] - 0.1055613458f * c1[i] - 0.0638541728f * c2[i];
+        auto s = c0[i] - 0.0894841775f * c1[i] - 1.2914855480f * c2[i];
+
+        l = l * l * l;
+        m = m * m * m;
+        s = s * s * s;
+
+        c0[i] =  4.0767416621f * l - 3.3077115913f * m + 0.2309699292f * s;
+        c1[i] = -1.2684380046f * l + 2.6097574011f * m - 0.3413193965f * s;
+        c2[i] = -0.0041960863f * l - 0.7034186147f * m + 1.7076147010f * s;
+    }
 }
 
 //==============================================================================
-bool DeepColour::operator== (const DeepColour& other) const noexcept
+template <typename T>
+bool BasicDeepColour<T>::operator== (const BasicDeepColour& other) const noexcept
 {
-    return juce::approximatelyEqual (a, other.a) &&
+    return juce::approximatelyEqual (getAlpha(), other.getAlpha()) &&
            juce::approximatelyEqual (getRed(), other.getRed()) &&
            juce::approximatelyEqual (getBlue(), other.getBlue()) &&
            juce::approximatelyEqual (getGreen(), other.getGreen());
 }
 
-bool DeepColour::operator!= (const DeepColour& other) const noexcept
+template <typename T>
+bool BasicDeepColour<T>::operator!= (const BasicDeepColour& other) const noexcept
 {
     return ! (*this == other);
 }
 
 //==============================================================================
-DeepColour::DeepColour (juce::uint32 c) noexcept
+template <typename T>
+BasicDeepColour<T>::BasicDeepColour (juce::uint32 c) noexcept
 {
-    a = (((c >> 24) & 0xff) / 255.0f);
-    col = RGB ((((c >> 16) & 0xff) / 255.0f), (((c >> 8)  & 0xff) / 255.0f), (((c >> 0)  & 0xff) / 255.0f));
+    a = T (Value ((c >> 24) & 0xff) / 255);
+    col = BasicRGB<T> (T (Value ((c >> 16) & 0xff) / 255), T (Value ((c >> 8) & 0xff) / 255), T (Value ((c >> 0) & 0xff) / 255));
 }
 
-DeepColour::DeepColour (HSB hsb, float alpha) noexcept
+template <typename T>
+BasicDeepColour<T>::BasicDeepColour (BasicHSB<T> hsb, Value alpha) noexcept
 {
-    a = alpha;
+    a = T (alpha);
     col = hsb;
 }
 
-DeepColour::DeepColour (RGB rgb, float alpha) noexcept
+template <typename T>
+BasicDeepColour<T>::BasicDeepColour (BasicRGB<T> rgb, Value alpha) noexcept
 {
-    a = alpha;
+    a = T (alpha);
     col = rgb;
 }
 
-DeepColour::DeepColour (const juce::Colour& c)
+template <typename T>
+BasicDeepColour<T>::BasicDeepColour (const juce::Colour& c)
 {
-    col = RGB ({c.getFloatRed(), c.getFloatGreen(), c.getFloatBlue()});
-    a = c.getFloatAlpha();
+    col = BasicRGB<T> (T (c.getFloatRed()), T (c.getFloatGreen()), T (c.getFloatBlue()));
+    a = T (c.getFloatAlpha());
 }
 
-DeepColour DeepColour::fromRGB (float red, float green, float blue) noexcept
+template <typename T>
+BasicDeepColour<T> BasicDeepColour<T>::fromRGB (Value red, Value green, Value blue) noexcept
 {
-    DeepColour c;
-    c.a = 1.0f;
-    c.col = RGB (red, green, blue);
-    return c;
+    return fromRGBA (red, green, blue, 1);
 }
 
-DeepColour DeepColour::fromRGBA (float red, float green, float blue, float alpha) noexcept
+template <typename T>
+BasicDeepColour<T> BasicDeepColour<T>::fromRGBA (Value red, Value green, Value blue, Value alpha) noexcept
 {
-    DeepColour c;
-    c.a = alpha;
-    c.col = RGB (red, green, blue);
+    BasicDeepColour c;
+    c.a = T (alpha);
+    c.col = BasicRGB<T> (T (red), T (green), T (blue));
     return c;
 }
 
-DeepColour DeepColour::fromHSB (float hue, float saturation, float brightness, float alpha) noexcept
+template <typename T>
+BasicDeepColour<T> BasicDeepColour<T>::fromHSB (Value hue, Value saturation, Value brightness, Value alpha) noexcept
 {
-    DeepColour c;
-    c.a = alpha;
-    c.col = HSB (hue, saturation, brightness);
+    BasicDeepColour c;
+    c.a = T (alpha);
+    c.col = BasicHSB<T> (T (hue), T (saturation), T (brightness));
     return c;
 }
 
+template <typename T>
+BasicDeepColour<T> BasicDeepColour<T>::fromOKLab (const OKLab& lab, Value alpha) noexcept
+{
+    return BasicDeepColour (BasicRGB<T> (oklabToRgb (lab)), alpha);
+}
+
 //==============================================================================
-HSB DeepColour::getHSB() const noexcept
+template <typename T>
+BasicHSB<T> BasicDeepColour<T>::getHSB() const noexcept
 {
-    if (auto hsb = std::get_if<HSB>(&col))
+    if (auto hsb = std::get_if<BasicHSB<T>>(&col))
         return *hsb;
-    else if (auto rgb = std::get_if<RGB>(&col))
+    else if (auto rgb = std::get_if<BasicRGB<T>>(&col))
         return rgbToHsb (*rgb);
 
     jassertfalse;
     return {};
 }
 
-RGB DeepColour::getRGB() const noexcept
+template <typename T>
+BasicRGB<T> BasicDeepColour<T>::getRGB() const noexcept
 {
-    if (auto hsb = std::get_if<HSB>(&col))
+    if (auto hsb = std::get_if<BasicHSB<T>>(&col))
         return hsbToRgb (*hsb);
-    else if (auto rgb = std::get_if<RGB>(&col))
+    else if (auto rgb = std::get_if<BasicRGB<T>>(&col))
         return *rgb;
 
     jassertfalse;
     return {};
 }
 
-float DeepColour::getRed() const noexcept           { return getRGB().r; }
-float DeepColour::getGreen() const noexcept         { return getRGB().g; }
-float DeepColour::getBlue() const noexcept          { return getRGB().b; }
+template <typename T>
+BasicRGB<T> BasicDeepColour<T>::getRGB (WorkingSpace space) const noexcept
+{
+    return convertRGB (getRGB(), WorkingSpace::sRGB, space);
+}
 
-float DeepColour::getHue() const noexcept           { return getHSB().h; }
-float DeepColour::getSaturation() const noexcept    { return getHSB().s; }
-float DeepColour::getBrightness() const noexcept    { return getHSB().b; }
+template <typename T>
+BasicDeepColour<T> BasicDeepColour<T>::fromRGB (const BasicRGB<T>& rgb, WorkingSpace space, Value alpha) noexcept
+{
+    return BasicDeepColour (convertRGB (rgb, space, WorkingSpace::sRGB), alpha);
+}
 
-juce::Colour DeepColour::getColour () const
+// OKLab and CIELab are only computed in float
+template <typename T>
+OKLab BasicDeepColour<T>::getOKLab() const noexcept
 {
-    return juce::Colour::fromFloatRGBA (getRed(), getGreen(), getBlue(), a);
+    return rgbToOklab (RGB (getRGB()));
 }
 
-DeepColour DeepColour::withAlpha (float newAlpha) const noexcept
+template <typename T>
+CIELab BasicDeepColour<T>::getLab() const noexcept
+{
+    return rgbToLab (RGB (getRGB()));
+}
+
+template <typename T> typename BasicDeepColour<T>::Value BasicDeepColour<T>::getRed() const noexcept           { return Value (getRGB().r); }
+template <typename T> typename BasicDeepColour<T>::Value BasicDeepColour<T>::getGreen() const noexcept         { return Value (getRGB().g); }
+template <typename T> typename BasicDeepColour<T>::Value BasicDeepColour<T>::getBlue() const noexcept          { return Value (getRGB().b); }
+
+template <typename T> typename BasicDeepColour<T>::Value BasicDeepColour<T>::getHue() const noexcept           { return Value (getHSB().h); }
+template <typename T> typename BasicDeepColour<T>::Value BasicDeepColour<T>::getSaturation() const noexcept    { return Value (getHSB().s); }
+template <typename T> typename BasicDeepColour<T>::Value BasicDeepColour<T>::getBrightness() const noexcept    { return Value (getHSB().b); }
+
+template <typename T>
+juce::Colour BasicDeepColour<T>::getColour () const
+{
+    auto rgb = RGB (getRGB());
+    return juce::Colour::fromFloatRGBA (rgb.r, rgb.g, rgb.b, float (getAlpha()));
+}
+
+template <typename T>
+BasicDeepColour<T> BasicDeepColour<T>::withAlpha (Value newAlpha) const noexcept
 {
     auto c = *this;
-    c.a = newAlpha;
+    c.a = T (newAlpha);
     return c;
 }
 
+//==============================================================================
+#define REFX_INSTANTIATE_DEEP_COLOUR(T) \
+    template class BasicDeepColour<T>; \
+    template BasicHSB<T> rgbToHsb (const BasicRGB<T>&); \
+    template BasicRGB<T> hsbToRgb (const BasicHSB<T>&); \
+    template BasicRGB<T> convertRGB (const BasicRGB<T>&, WorkingSpace, WorkingSpace) noexcept;
+
+REFX_INSTANTIATE_DEEP_COLOUR (float)
+REFX_INSTANTIATE_DEEP_COLOUR (double)
+REFX_INSTANTIATE_DEEP_COLOUR (UnitFixed<juce::uint8>)
+REFX_INSTANTIATE_DEEP_COLOUR (UnitFixed<juce::uint16>)
+
+#if REFX_HAS_FLOAT16
+REFX_INSTANTIATE_DEEP_COLOUR (_Float16)
+#endif
+
+#undef REFX_INSTANTIATE_DEEP_COLOUR
+
 }
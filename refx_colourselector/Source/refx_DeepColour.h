@@ -1,50 +1,220 @@
 #pragma once
 
+#ifndef REFX_HAS_FLOAT16
+ #if defined (__FLT16_MAX__)
+  #define REFX_HAS_FLOAT16 1
+ #else
+  #define REFX_HAS_FLOAT16 0
+ #endif
+#endif
+
 namespace reFX
 {
 
-struct RGB
+//==============================================================================
+/**
+    A value between 0.0 and 1.0 stored in an unsigned integer, for compact 8-bit
+    and 16-bit colour storage.
+
+    Values outside the range are clipped when they are stored.
+*/
+template <typename IntType>
+struct UnitFixed
 {
-    RGB() = default;
-    RGB (float r_, float g_, float b_) : r (r_), g (g_), b (b_) {}
+    static_assert (std::is_unsigned_v<IntType>, "UnitFixed needs an unsigned integer type");
 
-    float r = 0.0f;
-    float g = 0.0f;
+    UnitFixed() = default;
+    UnitFixed (float value) noexcept : raw (IntType (juce::jlimit (0.0f, 1.0f, value) * maxRaw + 0.5f)) {}
+
+    operator float() const noexcept                     { return float (raw) / maxRaw; }
+
+    IntType raw = 0;
+
+private:
+    static constexpr float maxRaw = float (std::numeric_limits<IntType>::max());
+};
+
+/** The type that colours stored with a scalar type are computed in: double for
+    double, and float for everything else.
+*/
+template <typename T> struct ColourScalar           { using Value = float; };
+template <>           struct ColourScalar<double>   { using Value = double; };
+
+template <typename T>
+using ColourValue = typename ColourScalar<T>::Value;
+
+//==============================================================================
+template <typename T>
+struct BasicRGB
+{
+    BasicRGB() = default;
+    BasicRGB (T r_, T g_, T b_) : r (r_), g (g_), b (b_) {}
+
+    /** Converts values stored with another scalar type. */
+    template <typename Other>
+    explicit BasicRGB (const BasicRGB<Other>& other)
+        : r (T (ColourValue<Other> (other.r))), g (T (ColourValue<Other> (other.g))), b (T (ColourValue<Other> (other.b))) {}
+
+    T r {};
+    T g {};
+    T b {};
+};
+
+template <typename T>
+struct BasicHSB
+{
+    BasicHSB() = default;
+    BasicHSB (T h_, T s_, T b_) : h (h_), s (s_), b (b_) {}
+
+    /** Converts values stored with another scalar type. */
+    template <typename Other>
+    explicit BasicHSB (const BasicHSB<Other>& other)
+        : h (T (ColourValue<Other> (other.h))), s (T (ColourValue<Other> (other.s))), b (T (ColourValue<Other> (other.b))) {}
+
+    T h {};
+    T s {};
+    T b {};
+};
+
+using RGB = BasicRGB<float>;
+using HSB = BasicHSB<float>;
+
+/** A colour in Bjorn Ottosson's OKLab space, which is perceptually uniform. */
+struct OKLab
+{
+    OKLab() = default;
+    OKLab (float L_, float a_, float b_) : L (L_), a (a_), b (b_) {}
+
+    float L = 0.0f;
+    float a = 0.0f;
     float b = 0.0f;
 };
 
-struct HSB
+/** A colour in CIE L*a*b* space, relative to a D65 white point. */
+struct CIELab
 {
-    HSB() = default;
-    HSB (float h_, float s_, float b_) : h (h_), s (s_), b (b_) {}
+    CIELab() = default;
+    CIELab (float L_, float a_, float b_) : L (L_), a (a_), b (b_) {}
 
-    float h = 0.0f;
-    float s = 0.0f;
+    float L = 0.0f;
+    float a = 0.0f;
     float b = 0.0f;
 };
 
+//==============================================================================
+template <typename T> BasicHSB<T> rgbToHsb (const BasicRGB<T>& rgb);
+template <typename T> BasicRGB<T> hsbToRgb (const BasicHSB<T>& hsb);
+
+/** Converts an sRGB encoded channel value to linear light. */
+float srgbToLinear (float value) noexcept;
+
+/** Converts a linear light channel value to sRGB encoding. */
+float linearToSrgb (float value) noexcept;
+
+/** Converts an 8-bit sRGB encoded channel value to linear light using a lookup table. */
+float srgb8ToLinear (juce::uint8 value) noexcept;
+
+/** Like srgbToLinear(), but interpolates a lookup table for values between 0 and 1.
+
+    The result is within 1e-6 of the exact curve. Values outside that range
+    are converted exactly, with the sign mirrored below 0.
+*/
+float srgbToLinearFast (float value) noexcept;
+
+/** Like linearToSrgb(), but interpolates a lookup table for values between 0 and 1.
+
+    The result is within 5e-5 of the exact curve, which is a fiftieth of an
+    8-bit step. Values outside that range are converted exactly, with the sign
+    mirrored below 0.
+*/
+float linearToSrgbFast (float value) noexcept;
+
+//==============================================================================
+/** The spaces that RGB values can be expressed in.
+
+    Display P3 uses the same transfer curve as sRGB, but wider primaries. Its
+    colours are held as sRGB values, which fall outside 0 to 1 for the colours
+    that sRGB can't show.
+*/
+enum class WorkingSpace
+{
+    sRGB,
+    linearSRGB,
+    displayP3
+};
+
+/** Converts RGB values from one space to another. The result isn't clipped. */
+template <typename T>
+BasicRGB<T> convertRGB (const BasicRGB<T>& rgb, WorkingSpace source, WorkingSpace target) noexcept;
+
+OKLab rgbToOklab (const RGB& rgb) noexcept;
+OKLab linearRgbToOklab (float r, float g, float b) noexcept;
+RGB oklabToRgb (const OKLab& lab) noexcept;
+
+CIELab rgbToLab (const RGB& rgb) noexcept;
+CIELab linearRgbToLab (float r, float g, float b) noexcept;
+
+//==============================================================================
+/*  Batch versions of the conversions, which convert colours stored as separate
+    channel arrays in place. Their loops have no branches, so that the compiler
+    can vectorise them.
+*/
+void rgbToHsb (float* redToHue, float* greenToSaturation, float* blueToBrightness, int num) noexcept;
+void hsbToRgb (float* hueToRed, float* saturationToGreen, float* brightnessToBlue, int num) noexcept;
+
+void srgbToLinear (float* values, int num) noexcept;
+void linearToSrgb (float* values, int num) noexcept;
+
+void convertRGB (float* red, float* green, float* blue, int num, WorkingSpace source, WorkingSpace target) noexcept;
+
+void linearRgbToOklab (float* redToL, float* greenToA, float* blueToB, int num) noexcept;
+void oklabToLinearRgb (float* lToRed, float* aToGreen, float* bToBlue, int num) noexcept;
+
 //==============================================================================
 /**
     Represents a colour, also including a transparency value.
 
-    The colour is stored internally as float red, green, blue and alpha values.
+    The colour is stored internally as red, green, blue and alpha values, or as
+    hue, saturation, brightness and alpha values, of the scalar type T. The
+    values are computed as float, or as double when T is double.
+
+    Use DeepColour, which stores floats, unless a colour table needs to be
+    smaller or more precise: DeepColourF64 stores doubles, DeepColourU8 and
+    DeepColourU16 store fixed point values between 0.0 and 1.0, and where the
+    compiler supports _Float16, DeepColourF16 stores half floats. Colours convert
+    between them with an explicit constructor.
 
     @tags{Graphics}
 */
-class DeepColour final
+template <typename T>
+class BasicDeepColour final
 {
 public:
+    /** The type the colour is computed with. */
+    using Value = ColourValue<T>;
+
     //==============================================================================
     /** Creates a transparent black colour. */
-    DeepColour() = default;
-
-    /** Creates a copy of another DeepColour object. */
-    DeepColour (const DeepColour&) = default;
+    BasicDeepColour() = default;
+
+    /** Creates a copy of another BasicDeepColour object. */
+    BasicDeepColour (const BasicDeepColour&) = default;
+
+    /** Converts a colour stored with another scalar type. */
+    template <typename Other>
+    explicit BasicDeepColour (const BasicDeepColour<Other>& other) noexcept
+        : a (T (Value (other.getAlpha())))
+    {
+        if (auto hsb = std::get_if<BasicHSB<Other>> (&other.col))
+            col = BasicHSB<T> (*hsb);
+        else
+            col = BasicRGB<T> (std::get<BasicRGB<Other>> (other.col));
+    }
 
     /** Creates a copy of a juce::Colour object. */
-    DeepColour (const juce::Colour&);
+    BasicDeepColour (const juce::Colour&);
 
-    /** Creates a DeepColour from a 32-bit ARGB value.
+    /** Creates a BasicDeepColour from a 32-bit ARGB value.
 
         The format of this number is:
             ((alpha << 24) | (red << 16) | (green << 8) | blue).
@@ -54,54 +224,54 @@ public:
 
         @see getPixelARGB
     */
-    explicit DeepColour (juce::uint32 argb) noexcept;
+    explicit BasicDeepColour (juce::uint32 argb) noexcept;
 
-    explicit DeepColour (HSB hsb, float alpha = 1.0f) noexcept;
+    explicit BasicDeepColour (BasicHSB<T> hsb, Value alpha = 1) noexcept;
 
-    explicit DeepColour (RGB rgb, float alpha = 1.0f) noexcept;
+    explicit BasicDeepColour (BasicRGB<T> rgb, Value alpha = 1) noexcept;
 
     /** Creates an opaque colour using float red, green and blue values */
-    static DeepColour fromRGB (float red, float green, float blue) noexcept;
+    static BasicDeepColour fromRGB (Value red, Value green, Value blue) noexcept;
 
     /** Creates a colour using 8-bit red, green, blue and alpha values. */
-    static DeepColour fromRGBA (float red, float green, float blue, float alpha) noexcept;
+    static BasicDeepColour fromRGBA (Value red, Value green, Value blue, Value alpha) noexcept;
 
     /** Creates a colour using floating point hue, saturation, brightness and alpha values.
 
         All values must be between 0.0 and 1.0.
         Numbers outside the valid range will be clipped.
     */
-    static DeepColour fromHSB (float hue,
-                               float saturation,
-                               float brightness,
-                               float alpha) noexcept;
+    static BasicDeepColour fromHSB (Value hue,
+                                    Value saturation,
+                                    Value brightness,
+                                    Value alpha) noexcept;
 
     /** Destructor. */
-    ~DeepColour() = default;
+    ~BasicDeepColour() = default;
 
     /** Copies another Colour object. */
-    DeepColour& operator= (const DeepColour&) = default;
+    BasicDeepColour& operator= (const BasicDeepColour&) = default;
 
     /** Compares two colours. */
-    bool operator== (const DeepColour& other) const noexcept;
+    bool operator== (const BasicDeepColour& other) const noexcept;
     /** Compares two colours. */
-    bool operator!= (const DeepColour& other) const noexcept;
+    bool operator!= (const BasicDeepColour& other) const noexcept;
 
     //==============================================================================
     /** Returns the red component of this colour.
         @returns a value between 0.0 and 1.0.
     */
-    float getRed() const noexcept;
+    Value getRed() const noexcept;
 
     /** Returns the green component of this colour.
         @returns a value between 0.0 and 1.0.
     */
-    float getGreen() const noexcept;
+    Value getGreen() const noexcept;
 
     /** Returns the blue component of this colour.
         @returns a value between 0.0 and 1.0.
     */
-    float getBlue() const noexcept;
+    Value getBlue() const noexcept;
 
     /** Returns the red component of this colour as a floating point value.
         @returns a value between 0.0 and 1.0
@@ -112,35 +282,52 @@ public:
 
         Alpha of 0.0 is completely transparent, 1.0 is completely opaque.
     */
-    float getAlpha() const noexcept                     { return a; }
+    Value getAlpha() const noexcept                     { return Value (a); }
 
-    DeepColour withAlpha (float newAlpha) const noexcept;
+    BasicDeepColour withAlpha (Value newAlpha) const noexcept;
 
     //==============================================================================
     /** Returns the colour's hue component.
         The value returned is in the range 0.0 to 1.0
     */
-    float getHue() const noexcept;
+    Value getHue() const noexcept;
 
     /** Returns the colour's saturation component.
         The value returned is in the range 0.0 to 1.0
     */
-    float getSaturation() const noexcept;
+    Value getSaturation() const noexcept;
 
     /** Returns the colour's brightness component.
         The value returned is in the range 0.0 to 1.0
     */
-    float getBrightness() const noexcept;
+    Value getBrightness() const noexcept;
 
     /** Returns the colour's hue, saturation and brightness components all at once.
         The values returned are in the range 0.0 to 1.0
     */
-    HSB getHSB() const noexcept;
+    BasicHSB<T> getHSB() const noexcept;
 
     /** Returns the colour's red, blue and green components all at once.
         The values returned are in the range 0.0 to 1.0
     */
-    RGB getRGB() const noexcept;
+    BasicRGB<T> getRGB() const noexcept;
+
+    /** Returns the colour's red, blue and green components in a working space.
+        Colours that the space can't show have values outside 0.0 to 1.0.
+    */
+    BasicRGB<T> getRGB (WorkingSpace space) const noexcept;
+
+    /** Creates a colour from red, green and blue values in a working space. */
+    static BasicDeepColour fromRGB (const BasicRGB<T>& rgb, WorkingSpace space, Value alpha = 1) noexcept;
+
+    /** Returns the colour in OKLab space. */
+    OKLab getOKLab() const noexcept;
+
+    /** Creates a colour from OKLab values, clipping it to the sRGB gamut. */
+    static BasicDeepColour fromOKLab (const OKLab& lab, Value alpha = 1) noexcept;
+
+    /** Returns the colour in CIE L*a*b* space. */
+    CIELab getLab() const noexcept;
 
     /** Returns a juce::Colour */
     juce::Colour getColour () const;
@@ -149,8 +336,37 @@ public:
 
 private:
     //==============================================================================
-    float a = 0.0f;
-    std::variant<HSB, RGB> col;
+    template <typename> friend class BasicDeepColour;
+
+    T a {};
+    std::variant<BasicHSB<T>, BasicRGB<T>> col;
 };
 
+using DeepColour    = BasicDeepColour<float>;
+using DeepColourF64 = BasicDeepColour<double>;
+using DeepColourU8  = BasicDeepColour<UnitFixed<juce::uint8>>;
+using DeepColourU16 = BasicDeepColour<UnitFixed<juce::uint16>>;
+
+#if REFX_HAS_FLOAT16
+using DeepColourF16 = BasicDeepColour<_Float16>;
+#endif
+
+// the colour types are instantiated once, in refx_DeepColour.cpp
+#define REFX_DECLARE_DEEP_COLOUR(T) \
+    extern template class BasicDeepColour<T>; \
+    extern template BasicHSB<T> rgbToHsb (const BasicRGB<T>&); \
+    extern template BasicRGB<T> hsbToRgb (const BasicHSB<T>&); \
+    extern template BasicRGB<T> convertRGB (const BasicRGB<T>&, WorkingSpace, WorkingSpace) noexcept;
+
+REFX_DECLARE_DEEP_COLOUR (float)
+REFX_DECLARE_DEEP_COLOUR (double)
+REFX_DECLARE_DEEP_COLOUR (UnitFixed<juce::uint8>)
+REFX_DECLARE_DEEP_COLOUR (UnitFixed<juce::uint16>)
+
+#if REFX_HAS_FLOAT16
+REFX_DECLARE_DEEP_COLOUR (_Float16)
+#endif
+
+#undef REFX_DECLARE_DEEP_COLOUR
+
 } // namespace reFX
@@ -0,0 +1,299 @@
+namespace reFX
+{
+
+namespace
+{
+    // "RFXT", then a version that changes with the format
+    constexpr int traceMagic = 0x54584652;
+    constexpr int traceVersion = 1;
+
+    // positions are stored as 16-bit fixed point, which covers drags that leave
+    // the component by up to its own size in every direction
+    constexpr float positionScale = 16384.0f;
+
+    juce::int16 toFixed (float value)
+    {
+        return (juce::int16) juce::jlimit (-32767, 32767, juce::roundToInt (value * positionScale));
+    }
+
+    bool hasIndex (DragTrace::Target target)
+    {
+        return target == DragTrace::Target::slider || target == DragTrace::Target::toggle;
+    }
+}
+
+//==============================================================================
+void DragTrace::writeTo (juce::OutputStream& output) const
+{
+    output.writeInt (traceMagic);
+    output.writeByte ((char) traceVersion);
+
+    output.writeInt (flags);
+    output.writeShort ((short) size.x);
+    output.writeShort ((short) size.y);
+    output.writeFloat (colour.getRed());
+    output.writeFloat (colour.getGreen());
+    output.writeFloat (colour.getBlue());
+    output.writeFloat (colour.getAlpha());
+    output.writeByte ((char) activeParam);
+    output.writeByte ((char) workingSpace);
+
+    output.writeCompressedInt ((int) events.size());
+
+    // the times are stored as the time since the previous event, which mostly fits a byte
+    juce::uint32 previous = 0;
+
+    for (auto& e : events)
+    {
+        output.writeCompressedInt ((int) (e.time - previous));
+        output.writeByte ((char) ((int) e.target | ((int) e.phase << 4)));
+
+        if (hasIndex (e.target))
+            output.writeByte ((char) e.index);
+
+        if (e.target != Target::toggle)
+        {
+            output.writeShort (toFixed (e.position.x));
+            output.writeShort (toFixed (e.position.y));
+        }
+
+        previous = e.time;
+    }
+}
+
+std::optional<DragTrace> DragTrace::readFrom (juce::InputStream& input)
+{
+    if (input.readInt() != traceMagic || input.readByte() != traceVersion)
+        return {};
+
+    DragTrace trace;
+
+    trace.flags = input.readInt();
+    trace.size.x = input.readShort();
+    trace.size.y = input.readShort();
+
+    auto r = input.readFloat();
+    auto g = input.readFloat();
+    auto b = input.readFloat();
+    auto a = input.readFloat();
+    trace.colour = DeepColour::fromRGBA (r, g, b, a);
+
+    auto param = (int) input.readByte();
+    auto space = (int) input.readByte();
+
+    if (! juce::isPositiveAndNotGreaterThan (param, (int) ColourSelector::Params::blue)
+         || ! juce::isPositiveAndNotGreaterThan (space, (int) WorkingSpace::displayP3))
+        return {};
+
+    trace.activeParam = (ColourSelector::Params) param;
+    trace.workingSpace = (WorkingSpace) space;
+
+    auto numEvents = input.readCompressedInt();
+
+    if (numEvents < 0)
+        return {};
+
+    // the count isn't trusted with a huge allocation before the events are read
+    trace.events.reserve ((size_t) juce::jmin (numEvents, 1 << 16));
+
+    juce::uint32 time = 0;
+
+    for (int i = 0; i < numEvents; ++i)
+    {
+        if (input.isExhausted())
+            return {};
+
+        Event e;
+
+        auto delta = input.readCompressedInt();
+        auto kind = (int) (juce::uint8) input.readByte();
+
+        auto target = kind & 0x0f;
+        auto phase = kind >> 4;
+
+        if (delta < 0 || target > (int) Target::toggle || phase > (int) Phase::up)
+            return {};
+
+        time += (juce::uint32) delta;
+        e.time = time;
+        e.target = (Target) target;
+        e.phase = (Phase) phase;
+
+        if (hasIndex (e.target))
+            e.index = (int) (juce::uint8) input.readByte();
+
+        if (e.target != Target::toggle)
+        {
+            auto x = input.readShort();
+            auto y = input.readShort();
+            e.position = { (float) x / positionScale, (float) y / positionScale };
+        }
+
+        trace.events.push_back (e);
+    }
+
+    return trace;
+}
+
+//==============================================================================
+DragTrace::Recorder::Recorder (ColourSelector& selector)
+    : owner (selector), start (juce::Time::getCurrentTime())
+{
+    trace.flags = owner.flags;
+    trace.size = { owner.getWidth(), owner.getHeight() };
+    trace.colour = owner.colour;
+    trace.activeParam = owner.activeParam;
+    trace.workingSpace = owner.workingSpace;
+
+    owner.addMouseListener (this, true);
+}
+
+DragTrace::Recorder::~Recorder()
+{
+    owner.removeMouseListener (this);
+}
+
+void DragTrace::Recorder::record (const juce::MouseEvent& e, Phase phase)
+{
+    Event event;
+    event.phase = phase;
+
+    auto* c = e.eventComponent;
+
+    if (c == owner.parameter2D.get())
+    {
+        event.target = Target::plane;
+    }
+    else if (c == owner.parameter1D.get())
+    {
+        event.target = Target::strip;
+    }
+    else if (c == owner.hueWheel.get())
+    {
+        event.target = Target::wheel;
+    }
+    else if (auto slider = std::find (owner.sliders.begin(), owner.sliders.end(), c); slider != owner.sliders.end())
+    {
+        event.target = Target::slider;
+        event.index = (int) std::distance (owner.sliders.begin(), slider);
+    }
+    else if (auto toggle = std::find (owner.toggles.begin(), owner.toggles.end(), c); toggle != owner.toggles.end())
+    {
+        // the button has handled the click by now, so only the parameter it chose is kept
+        if (phase != Phase::up || ! (*toggle)->getToggleState())
+            return;
+
+        event.target = Target::toggle;
+        event.index = (*toggle)->getName().getIntValue();
+    }
+    else
+    {
+        return;
+    }
+
+    if (c->getWidth() <= 0 || c->getHeight() <= 0)
+        return;
+
+    // the events of the OS can arrive slightly out of order, but the trace stores increasing times
+    auto previous = trace.events.empty() ? juce::uint32 (0) : trace.events.back().time;
+    event.time = (juce::uint32) juce::jmax ((juce::int64) previous, (e.eventTime - start).inMilliseconds());
+
+    event.position = { e.position.x / (float) c->getWidth(),
+                       e.position.y / (float) c->getHeight() };
+
+    trace.events.push_back (event);
+}
+
+void DragTrace::Recorder::mouseDown (const juce::MouseEvent& e)
+{
+    record (e, Phase::down);
+}
+
+void DragTrace::Recorder::mouseDrag (const juce::MouseEvent& e)
+{
+    record (e, Phase::drag);
+}
+
+void DragTrace::Recorder::mouseUp (const juce::MouseEvent& e)
+{
+    record (e, Phase::up);
+}
+
+//==============================================================================
+DragTrace::Player::Player (ColourSelector& selector, const DragTrace& trace)
+    : owner (selector)
+{
+    owner.playingTrace = true;
+    owner.createComponents();
+
+    owner.setWorkingSpace (trace.workingSpace);
+    owner.setActiveParam (trace.activeParam);
+    owner.setCurrentColour (trace.colour, juce::dontSendNotification);
+}
+
+DragTrace::Player::~Player()
+{
+    owner.playingTrace = false;
+    owner.playingDrag = false;
+}
+
+juce::Component* DragTrace::Player::getComponent (const Event& event) const
+{
+    switch (event.target)
+    {
+        case Target::plane:     return owner.parameter2D.get();
+        case Target::strip:     return owner.parameter1D.get();
+        case Target::wheel:     return owner.hueWheel.get();
+        case Target::slider:    return juce::isPositiveAndBelow (event.index, owner.sliders.size()) ? owner.sliders[event.index] : nullptr;
+        case Target::toggle:
+        default:                break;
+    }
+
+    return nullptr;
+}
+
+bool DragTrace::Player::play (const Event& event)
+{
+    if (event.target == Target::toggle)
+    {
+        owner.setActiveParam ((ColourSelector::Params) event.index);
+        return true;
+    }
+
+    auto* c = getComponent (event);
+
+    if (c == nullptr)
+        return false;
+
+    auto position = juce::Point<float> (event.position.x * (float) c->getWidth(),
+                                        event.position.y * (float) c->getHeight());
+    auto now = juce::Time::getCurrentTime();
+
+    if (event.phase == Phase::down)
+    {
+        downPosition = position;
+        downTime = now;
+    }
+
+    // as with a real mouse, the button is already up when mouseUp() is called
+    owner.playingDrag = event.phase != Phase::up;
+
+    const juce::MouseEvent e (juce::Desktop::getInstance().getMainMouseSource(), position,
+                              juce::ModifierKeys (juce::ModifierKeys::leftButtonModifier),
+                              juce::MouseInputSource::defaultPressure, juce::MouseInputSource::defaultOrientation,
+                              juce::MouseInputSource::defaultRotation, juce::MouseInputSource::defaultTiltX,
+                              juce::MouseInputSource::defaultTiltY, c, c, now, downPosition, downTime, 1,
+                              event.phase != Phase::down && position != downPosition);
+
+    switch (event.phase)
+    {
+        case Phase::down:   c->mouseDown (e); break;
+        case Phase::drag:   c->mouseDrag (e); break;
+        case Phase::up:     c->mouseUp (e);   break;
+        default:            break;
+    }
+
+    return true;
+}
+
+} // namespace reFX
@@ -0,0 +1,153 @@
+#pragma once
+
+namespace reFX
+{
+
+//==============================================================================
+/**
+    A recording of what the user did with the colour plane, the strip, the hue
+    wheel, the sliders and the toggles of a ColourSelector, which can be played
+    back into another selector to reproduce how it behaved.
+
+    Each event holds its time and its position relative to the component it was
+    made on, so a trace recorded at one size plays back at another. The trace
+    also holds the options, size, colour, active parameter and working space of
+    the selector when the recording started.
+
+    Traces are written to a compact binary stream of about seven bytes per event.
+
+    @code
+    DragTrace::Recorder recorder (selector);
+    ...
+    juce::FileOutputStream out (file);
+    recorder.getTrace().writeTo (out);
+    @endcode
+
+    @tags{GUI}
+*/
+class DragTrace
+{
+public:
+    //==============================================================================
+    /** The part of the selector an event was made on. */
+    enum class Target : juce::uint8
+    {
+        plane,
+        strip,
+        wheel,
+        slider,
+        toggle,
+    };
+
+    enum class Phase : juce::uint8
+    {
+        down,
+        drag,
+        up,
+    };
+
+    struct Event
+    {
+        /** The time since the recording started, in milliseconds. */
+        juce::uint32 time = 0;
+
+        Target target = Target::plane;
+        Phase phase = Phase::down;
+
+        /** For a slider, its index in the order they are laid out. For a toggle, the Params it selects. */
+        int index = 0;
+
+        /** The position, as a fraction of the component's width and height. */
+        juce::Point<float> position;
+    };
+
+    //==============================================================================
+    int flags = 0;
+    juce::Point<int> size;
+    DeepColour colour;
+    ColourSelector::Params activeParam = ColourSelector::Params::hue;
+    WorkingSpace workingSpace = WorkingSpace::sRGB;
+
+    std::vector<Event> events;
+
+    //==============================================================================
+    /** Writes the trace to a stream. */
+    void writeTo (juce::OutputStream& output) const;
+
+    /** Reads a trace written by writeTo(). Returns std::nullopt if the stream doesn't hold one. */
+    static std::optional<DragTrace> readFrom (juce::InputStream& input);
+
+    //==============================================================================
+    class Recorder;
+    class Player;
+};
+
+//==============================================================================
+/**
+    Records the mouse events of a selector into a DragTrace, from when it is
+    created until it is deleted.
+
+    @tags{GUI}
+*/
+class DragTrace::Recorder  : private juce::MouseListener
+{
+public:
+    explicit Recorder (ColourSelector& selector);
+    ~Recorder() override;
+
+    /** Returns the events recorded so far. */
+    const DragTrace& getTrace() const noexcept      { return trace; }
+
+private:
+    ColourSelector& owner;
+    DragTrace trace;
+    juce::Time start;
+
+    void record (const juce::MouseEvent&, Phase);
+
+    void mouseDown (const juce::MouseEvent&) override;
+    void mouseDrag (const juce::MouseEvent&) override;
+    void mouseUp (const juce::MouseEvent&) override;
+
+    JUCE_DECLARE_NON_COPYABLE (Recorder)
+};
+
+//==============================================================================
+/**
+    Sends the events of a trace to a selector, as if the user made them.
+
+    The selector's components are created even if it isn't showing, so a trace
+    can be played into a selector that is only painted into images. While the
+    player exists, the selector keeps its cached images as though it were on
+    screen, and treats a drag that is being played like a real one.
+
+    The player doesn't pace the events. Send each one when it is due.
+
+    @tags{GUI}
+*/
+class DragTrace::Player
+{
+public:
+    /** Sets the selector to the colour, active parameter and working space the
+        trace was recorded with. It should have the same options, and is best
+        laid out at the same size.
+    */
+    Player (ColourSelector& selector, const DragTrace& trace);
+    ~Player();
+
+    /** Sends an event to the component it was recorded on. Returns false if the
+        selector has no such component.
+    */
+    bool play (const Event& event);
+
+private:
+    ColourSelector& owner;
+    juce::Point<float> downPosition;
+    juce::Time downTime;
+
+    juce::Component* getComponent (const Event&) const;
+
+    JUCE_DECLARE_NON_COPYABLE (Player)
+};
+
+} // namespace reFX
@@ -0,0 +1,460 @@
+namespace reFX
+{
+
+//==============================================================================
+GradientLUT::GradientLUT (const DeepColour& start, const DeepColour& end, Space space_)
+    : space (space_)
+{
+    addStop (0.0f, start);
+    addStop (1.0f, end);
+}
+
+int GradientLUT::addStop (float position, const DeepColour& colour)
+{
+    position = juce::jlimit (0.0f, 1.0f, position);
+
+    auto it = std::upper_bound (stops.begin(), stops.end(), position,
+                                [] (float p, const Stop& s) { return p < s.position; });
+
+    return int (std::distance (stops.begin(), stops.insert (it, { position, colour })));
+}
+
+void GradientLUT::removeStop (int index)
+{
+    if (juce::isPositiveAndBelow (index, getNumStops()))
+        stops.erase (stops.begin() + index);
+}
+
+int GradientLUT::setStopPosition (int index, float newPosition)
+{
+    if (! juce::isPositiveAndBelow (index, getNumStops()))
+        return -1;
+
+    auto colour = stops[size_t (index)].colour;
+    removeStop (index);
+    return addStop (newPosition, colour);
+}
+
+void GradientLUT::setStopColour (int index, const DeepColour& newColour)
+{
+    if (juce::isPositiveAndBelow (index, getNumStops()))
+        stops[size_t (index)].colour = newColour;
+}
+
+void GradientLUT::clearStops()
+{
+    stops.clear();
+}
+
+//==============================================================================
+void GradientLUT::bake (float* red, float* green, float* blue, float* alpha, int num) const
+{
+    if (num <= 0)
+        return;
+
+    if (stops.empty())
+    {
+        std::fill (red, red + num, 0.0f);
+        std::fill (green, green + num, 0.0f);
+        std::fill (blue, blue + num, 0.0f);
+        std::fill (alpha, alpha + num, 0.0f);
+        return;
+    }
+
+    // convert the stops into the interpolation space once
+    const auto numStops = stops.size();
+    stopScratch.resize (numStops * 4);
+
+    float* values[] = { stopScratch.data(),
+                        stopScratch.data() + numStops,
+                        stopScratch.data() + numStops * 2,
+                        stopScratch.data() + numStops * 3 };
+
+    for (size_t i = 0; i < numStops; ++i)
+    {
+        const auto& c = stops[i].colour;
+        values[3][i] = c.getAlpha();
+
+        if (space == Space::hsb)
+        {
+            auto hsb = c.getHSB();
+            values[0][i] = hsb.h;
+            values[1][i] = hsb.s;
+            values[2][i] = hsb.b;
+        }
+        else if (space == Space::okLab)
+        {
+            auto lab = c.getOKLab();
+            values[0][i] = lab.L;
+            values[1][i] = lab.a;
+            values[2][i] = lab.b;
+        }
+        else
+        {
+            auto rgb = c.getRGB();
+            values[0][i] = rgb.r;
+            values[1][i] = rgb.g;
+            values[2][i] = rgb.b;
+
+            if (space == Space::linearRGB)
+                for (int ch = 0; ch < 3; ++ch)
+                    values[size_t (ch)][i] = srgbToLinear (values[size_t (ch)][i]);
+        }
+    }
+
+    if (space == Space::hsb)
+    {
+        auto* hue = values[0];
+        auto isGrey = [&] (size_t i) { return values[1][i] <= 0.0f || values[2][i] <= 0.0f; };
+
+        // greys have no meaningful hue, so they take the hue of their closest coloured
+        // neighbour, which stops a fade to grey from sweeping through the rainbow
+        for (size_t i = 0; i < numStops; ++i)
+        {
+            if (! isGrey (i))
+                continue;
+
+            for (size_t d = 1; d < numStops; ++d)
+            {
+                if (i >= d && ! isGrey (i - d))
+                {
+                    hue[i] = hue[i - d];
+                    break;
+                }
+
+                if (i + d < numStops && ! isGrey (i + d))
+                {
+                    hue[i] = hue[i + d];
+                    break;
+                }
+            }
+        }
+
+        // unwrap the hues, so that every segment takes the shorter way around the circle
+        for (size_t i = 1; i < numStops; ++i)
+            hue[i] += std::round (hue[i - 1] - hue[i]);
+    }
+
+    // interpolate each segment. The inner loops are plain lerps, which the compiler vectorises.
+    float* out[] = { red, green, blue, alpha };
+    const auto scale = float (juce::jmax (1, num - 1));
+
+    auto indexAt = [&] (float position) { return juce::jlimit (0, num, int (std::ceil (position * scale))); };
+
+    auto first = indexAt (stops.front().position);
+
+    for (size_t ch = 0; ch < 4; ++ch)
+        std::fill (out[ch], out[ch] + first, values[ch][0]);
+
+    for (size_t s = 0; s + 1 < numStops; ++s)
+    {
+        auto p0 = stops[s].position;
+        auto p1 = stops[s + 1].position;
+        auto begin = indexAt (p0);
+        auto end = indexAt (p1);
+
+        if (end <= begin)
+            continue;
+
+        auto invWidth = 1.0f / juce::jmax (1.0e-6f, p1 - p0);
+
+        for (size_t ch = 0; ch < 4; ++ch)
+        {
+            auto v0 = values[ch][s];
+            auto dv = values[ch][s + 1] - v0;
+            auto* dest = out[ch];
+
+            for (int i = begin; i < end; ++i)
+                dest[i] = v0 + dv * juce::jlimit (0.0f, 1.0f, (float (i) / scale - p0) * invWidth);
+        }
+    }
+
+    auto last = juce::jmax (first, indexAt (stops.back().position));
+
+    for (size_t ch = 0; ch < 4; ++ch)
+        std::fill (out[ch] + last, out[ch] + num, values[ch][numStops - 1]);
+
+    // and convert back to sRGB in batch
+    if (space == Space::hsb)
+    {
+        hsbToRgb (red, green, blue, num);
+    }
+    else if (space == Space::okLab)
+    {
+        oklabToLinearRgb (red, green, blue, num);
+
+        for (auto* channel : { red, green, blue })
+            linearToSrgb (channel, num);
+    }
+    else if (space == Space::linearRGB)
+    {
+        for (auto* channel : { red, green, blue })
+            linearToSrgb (channel, num);
+    }
+
+    for (auto* channel : out)
+        for (int i = 0; i < num; ++i)
+            channel[i] = juce::jlimit (0.0f, 1.0f, channel[i]);
+}
+
+void GradientLUT::bake (juce::PixelARGB* pixels, int num) const
+{
+    if (num <= 0)
+        return;
+
+    channelScratch.resize (size_t (num) * 4);
+
+    auto* r = channelScratch.data();
+    auto* g = r + num;
+    auto* b = g + num;
+    auto* a = b + num;
+
+    bake (r, g, b, a, num);
+
+    for (int i = 0; i < num; ++i)
+    {
+        auto alpha = a[i];
+        pixels[i].setARGB (juce::uint8 (alpha * 255.0f + 0.5f),
+                           juce::uint8 (r[i] * alpha * 255.0f + 0.5f),
+                           juce::uint8 (g[i] * alpha * 255.0f + 0.5f),
+                           juce::uint8 (b[i] * alpha * 255.0f + 0.5f));
+    }
+}
+
+DeepColour GradientLUT::getColourAtPosition (float position) const
+{
+    if (stops.empty())
+        return {};
+
+    // bake a single entry by shifting the stops so the position lands on index 0
+    GradientLUT single;
+    single.space = space;
+
+    for (auto& s : stops)
+        single.stops.push_back ({ s.position - juce::jlimit (0.0f, 1.0f, position), s.colour });
+
+    float r, g, b, a;
+    single.bake (&r, &g, &b, &a, 1);
+
+    return DeepColour::fromRGBA (r, g, b, a);
+}
+
+//==============================================================================
+GradientEditor::GradientEditor()
+{
+    gradient.addStop (0.0f, DeepColour (juce::Colours::black));
+    gradient.addStop (1.0f, DeepColour (juce::Colours::white));
+    gradient.setSpace (GradientLUT::Space::okLab);
+}
+
+GradientEditor::~GradientEditor()
+{
+}
+
+void GradientEditor::setGradient (const GradientLUT& newGradient)
+{
+    gradient = newGradient;
+    selectedStop = -1;
+    strip = {};
+    repaint();
+}
+
+void GradientEditor::setSpace (GradientLUT::Space newSpace)
+{
+    if (gradient.getSpace() != newSpace)
+    {
+        gradient.setSpace (newSpace);
+        gradientChanged();
+    }
+}
+
+void GradientEditor::setSelectedStopColour (const DeepColour& newColour)
+{
+    if (selectedStop >= 0)
+    {
+        gradient.setStopColour (selectedStop, newColour);
+        gradientChanged();
+    }
+}
+
+//==============================================================================
+juce::Rectangle<int> GradientEditor::getBarArea() const
+{
+    auto markerSize = juce::jmax (8, getHeight() / 3);
+    return getLocalBounds().reduced (markerSize / 2, 0).withTrimmedBottom (markerSize);
+}
+
+juce::Rectangle<float> GradientEditor::getStopArea (int index) const
+{
+    auto bar = getBarArea();
+    auto markerSize = float (getHeight() - bar.getBottom());
+    auto x = float (bar.getX()) + gradient.getStop (index).position * float (bar.getWidth());
+
+    return { x - markerSize * 0.5f, float (bar.getBottom()), markerSize, markerSize };
+}
+
+int GradientEditor::getStopAt (juce::Point<float> pos) const
+{
+    for (int i = gradient.getNumStops(); --i >= 0;)
+        if (getStopArea (i).expanded (2.0f).contains (pos))
+            return i;
+
+    return -1;
+}
+
+float GradientEditor::getPositionFor (float x) const
+{
+    auto bar = getBarArea();
+    return juce::jlimit (0.0f, 1.0f, (x - float (bar.getX())) / float (juce::jmax (1, bar.getWidth())));
+}
+
+void GradientEditor::select (int index)
+{
+    if (selectedStop != index)
+    {
+        selectedStop = index;
+        repaint();
+
+        if (onSelectionChanged)
+            onSelectionChanged (selectedStop);
+    }
+}
+
+void GradientEditor::gradientChanged()
+{
+    strip = {};
+    repaint();
+    sendChangeMessage();
+}
+
+void GradientEditor::updateStrip (float scale)
+{
+    auto bar = getBarArea();
+    auto w = juce::jmax (1, juce::roundToInt (float (bar.getWidth()) * scale));
+
+    if (strip.isNull() || strip.getWidth() != w)
+        strip = juce::Image (juce::Image::ARGB, w, 1, false);
+
+    juce::Image::BitmapData pixels (strip, juce::Image::BitmapData::writeOnly);
+    gradient.bake ((juce::PixelARGB*) pixels.getLinePointer (0), w);
+
+    stripScale = scale;
+}
+
+//==============================================================================
+void GradientEditor::paint (juce::Graphics& g)
+{
+    auto bar = getBarArea();
+
+    if (bar.isEmpty())
+        return;
+
+    auto scale = float (g.getInternalContext().getPhysicalPixelScaleFactor());
+
+    if (strip.isNull() || ! juce::approximatelyEqual (scale, stripScale))
+        updateStrip (scale);
+
+    g.fillCheckerBoard (bar.toFloat(), 8.0f, 8.0f, juce::Colours::grey, juce::Colours::white);
+    g.drawImage (strip, bar.toFloat(), juce::RectanglePlacement::stretchToFit);
+
+    g.setColour (juce::Colours::black.withAlpha (0.5f));
+    g.drawRect (bar);
+
+    for (int i = 0; i < gradient.getNumStops(); ++i)
+    {
+        auto area = getStopArea (i).reduced (1.0f);
+
+        juce::Path p;
+        p.addTriangle (area.getCentreX(), area.getY(), area.getRight(), area.getBottom(), area.getX(), area.getBottom());
+
+        g.setColour (gradient.getStop (i).colour.getColour().withAlpha (1.0f));
+        g.fillPath (p);
+
+        g.setColour (i == selectedStop ? juce::Colours::white : juce::Colours::black);
+        g.strokePath (p, juce::PathStrokeType (i == selectedStop ? 2.0f : 1.0f));
+    }
+}
+
+void GradientEditor::resized()
+{
+    strip = {};
+}
+
+size_t GradientEditor::getCacheBytes() const
+{
+    return RasterCache::getImageBytes (strip);
+}
+
+void GradientEditor::releaseCache()
+{
+    strip = {};
+}
+
+bool GradientEditor::isCacheShowing() const
+{
+    return isShowing();
+}
+
+void GradientEditor::mouseDown (const juce::MouseEvent& e)
+{
+    draggedOff = false;
+    select (getStopAt (e.position));
+}
+
+void GradientEditor::mouseDrag (const juce::MouseEvent& e)
+{
+    if (selectedStop < 0)
+        return;
+
+    // dragging a stop well away from the bar removes it, as long as two remain
+    auto off = gradient.getNumStops() > 2 && e.position.y > float (getHeight() + 20);
+
+    if (off != draggedOff)
+    {
+        draggedOff = off;
+        setMouseCursor (off ? juce::MouseCursor::DraggingHandCursor : juce::MouseCursor::NormalCursor);
+        repaint();
+    }
+
+    if (! off)
+    {
+        auto index = gradient.setStopPosition (selectedStop, getPositionFor (e.position.x));
+
+        if (index != selectedStop)
+        {
+            selectedStop = index;
+
+            if (onSelectionChanged)
+                onSelectionChanged (selectedStop);
+        }
+
+        gradientChanged();
+    }
+}
+
+void GradientEditor::mouseUp (const juce::MouseEvent&)
+{
+    if (draggedOff && selectedStop >= 0)
+    {
+        gradient.removeStop (selectedStop);
+        select (-1);
+        gradientChanged();
+    }
+
+    draggedOff = false;
+    setMouseCursor (juce::MouseCursor::NormalCursor);
+}
+
+void GradientEditor::mouseDoubleClick (const juce::MouseEvent& e)
+{
+    if (getStopAt (e.position) >= 0 || ! getBarArea().contains (e.getPosition()))
+        return;
+
+    auto position = getPositionFor (e.position.x);
+    auto index = gradient.addStop (position, gradient.getColourAtPosition (position));
+
+    select (index);
+    gradientChanged();
+}
+
+} // namespace reFX
@@ -0,0 +1,162 @@
+#pragma once
+
+namespace reFX
+{
+
+//==============================================================================
+/**
+    A colour gradient between any number of stops, which can be baked into
+    lookup tables.
+
+    The stops are interpolated in a chosen colour space. Baking converts the
+    stops once, interpolates all entries of the table, and converts them back
+    to sRGB in batch. So re-baking a table of a thousand entries is cheap enough
+    to do on every mouse drag. Baking reuses scratch buffers inside the object,
+    so don't bake the same GradientLUT on several threads at once.
+
+    @tags{Graphics}
+*/
+class GradientLUT
+{
+public:
+    //==============================================================================
+    /** The colour space that the stops are interpolated in. */
+    enum class Space
+    {
+        sRGB,           /**< straight between the sRGB encoded values, like juce::ColourGradient */
+        linearRGB,      /**< between the linear light values, which keeps mixes bright */
+        hsb,            /**< hue, saturation and brightness, taking the shorter way around the hue circle */
+        okLab,          /**< perceptually even steps */
+    };
+
+    struct Stop
+    {
+        float position = 0.0f;
+        DeepColour colour;
+    };
+
+    //==============================================================================
+    /** Creates a gradient without any stops. */
+    GradientLUT() = default;
+
+    /** Creates a gradient from one colour to another. */
+    GradientLUT (const DeepColour& start, const DeepColour& end, Space space = Space::sRGB);
+
+    //==============================================================================
+    /** Adds a stop, keeping the stops sorted by position. Returns the index of the new stop. */
+    int addStop (float position, const DeepColour& colour);
+
+    /** Removes a stop. */
+    void removeStop (int index);
+
+    /** Moves a stop, returning its new index after sorting. */
+    int setStopPosition (int index, float newPosition);
+
+    /** Changes the colour of a stop. */
+    void setStopColour (int index, const DeepColour& newColour);
+
+    /** Removes all the stops. */
+    void clearStops();
+
+    int getNumStops() const noexcept                    { return int (stops.size()); }
+    const Stop& getStop (int index) const               { return stops[size_t (index)]; }
+    const std::vector<Stop>& getStops() const noexcept  { return stops; }
+
+    void setSpace (Space newSpace) noexcept             { space = newSpace; }
+    Space getSpace() const noexcept                     { return space; }
+
+    //==============================================================================
+    /** Fills a table with colours evenly spaced from position 0.0 to 1.0.
+
+        The channels are unpremultiplied, sRGB encoded and between 0.0 and 1.0.
+        Positions before the first stop or after the last get their colour.
+    */
+    void bake (float* red, float* green, float* blue, float* alpha, int num) const;
+
+    /** Fills a table of premultiplied pixels, evenly spaced from position 0.0 to 1.0. */
+    void bake (juce::PixelARGB* pixels, int num) const;
+
+    /** Returns the colour at a position between 0.0 and 1.0. */
+    DeepColour getColourAtPosition (float position) const;
+
+private:
+    //==============================================================================
+    std::vector<Stop> stops;
+    Space space = Space::sRGB;
+
+    // scratch buffers reused by bake(), so baking a table of the same size doesn't allocate
+    mutable std::vector<float> stopScratch, channelScratch;
+
+    JUCE_LEAK_DETECTOR (GradientLUT)
+};
+
+//==============================================================================
+/**
+    A component that shows a baked GradientLUT and lets the user edit its stops.
+
+    Drag a stop to move it, drag it away from the bar to remove it, and
+    double-click the bar to add a stop. The gradient is re-baked on every
+    change.
+
+    @tags{GUI}
+*/
+class GradientEditor  : public juce::Component,
+                        public juce::ChangeBroadcaster,
+                        public RasterCache::Owner
+{
+public:
+    //==============================================================================
+    GradientEditor();
+    ~GradientEditor() override;
+
+    //==============================================================================
+    /** Replaces the gradient being edited. */
+    void setGradient (const GradientLUT& newGradient);
+
+    /** Returns the gradient being edited. */
+    const GradientLUT& getGradient() const noexcept     { return gradient; }
+
+    /** Changes the interpolation space of the gradient. */
+    void setSpace (GradientLUT::Space newSpace);
+
+    /** Returns the index of the selected stop, or -1. */
+    int getSelectedStop() const noexcept                { return selectedStop; }
+
+    /** Changes the colour of the selected stop, for example from a ColourSelector. */
+    void setSelectedStopColour (const DeepColour& newColour);
+
+    /** Called when a different stop gets selected. */
+    std::function<void (int)> onSelectionChanged;
+
+    //==============================================================================
+    void paint (juce::Graphics&) override;
+    void resized() override;
+    void mouseDown (const juce::MouseEvent&) override;
+    void mouseDrag (const juce::MouseEvent&) override;
+    void mouseUp (const juce::MouseEvent&) override;
+    void mouseDoubleClick (const juce::MouseEvent&) override;
+
+    size_t getCacheBytes() const override;
+    void releaseCache() override;
+    bool isCacheShowing() const override;
+
+private:
+    //==============================================================================
+    GradientLUT gradient;
+    juce::Image strip;
+    float stripScale = 1.0f;
+    int selectedStop = -1;
+    bool draggedOff = false;
+
+    juce::Rectangle<int> getBarArea() const;
+    juce::Rectangle<float> getStopArea (int index) const;
+    int getStopAt (juce::Point<float>) const;
+    float getPositionFor (float x) const;
+    void select (int index);
+    void gradientChanged();
+    void updateStrip (float scale);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (GradientEditor)
+};
+
+} // namespace reFX
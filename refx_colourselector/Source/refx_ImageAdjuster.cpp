@@ -0,0 +1,195 @@
+namespace reFX
+{
+
+//==============================================================================
+namespace
+{
+    /** Adjusts one row of unpremultiplied channel values, in place. */
+    void adjustRow (float* r, float* g, float* b, int num, const ImageAdjuster::Settings& settings,
+                    const HSB& tint) noexcept
+    {
+        rgbToHsb (r, g, b, num);
+
+        // r, g and b now hold hue, saturation and brightness
+        const auto hueShift = settings.hueShift - std::floor (settings.hueShift);
+        const auto amount = juce::jlimit (0.0f, 1.0f, settings.tintAmount);
+
+        // a grey tint has no hue to move towards, it only desaturates
+        const auto hueAmount = tint.s > 0.0f ? amount : 0.0f;
+
+        for (int i = 0; i < num; ++i)
+        {
+            auto h = r[i] + hueShift;
+            h = h >= 1.0f ? h - 1.0f : h;
+
+            auto s = juce::jlimit (0.0f, 1.0f, g[i] * settings.saturation);
+
+            // tinting moves the hue the shorter way around the circle
+            auto dh = tint.h - h;
+            dh -= std::round (dh);
+
+            r[i] = h + dh * hueAmount;
+            g[i] = s + (tint.s - s) * amount;
+            b[i] = juce::jlimit (0.0f, 1.0f, b[i] * settings.brightness);
+        }
+
+        hsbToRgb (r, g, b, num);
+    }
+}
+
+//==============================================================================
+bool ImageAdjuster::Settings::isIdentity() const noexcept
+{
+    return juce::approximatelyEqual (hueShift - std::round (hueShift), 0.0f)
+        && juce::approximatelyEqual (saturation, 1.0f)
+        && juce::approximatelyEqual (brightness, 1.0f)
+        && tintAmount <= 0.0f;
+}
+
+//==============================================================================
+ImageAdjuster::ImageAdjuster (const juce::Image& source_, int maxPreviewSize)
+{
+    setSource (source_, maxPreviewSize);
+}
+
+void ImageAdjuster::setSource (const juce::Image& newSource, int maxPreviewSize)
+{
+    source = newSource;
+    preview = {};
+
+    if (source.isNull())
+    {
+        proxy = {};
+        return;
+    }
+
+    auto w = source.getWidth();
+    auto h = source.getHeight();
+    auto scale = juce::jmin (1.0f, float (maxPreviewSize) / float (juce::jmax (w, h)));
+
+    if (scale < 1.0f)
+        proxy = source.rescaled (juce::jmax (1, juce::roundToInt (float (w) * scale)),
+                                 juce::jmax (1, juce::roundToInt (float (h) * scale)),
+                                 juce::Graphics::mediumResamplingQuality);
+    else
+        proxy = source;
+}
+
+const juce::Image& ImageAdjuster::getPreview (const Settings& settings)
+{
+    // the preview never shares its pixels with the proxy, so the proxy stays untouched
+    apply (proxy, preview, settings);
+    return preview;
+}
+
+juce::Image ImageAdjuster::commit (const Settings& settings) const
+{
+    juce::Image result;
+    apply (source, result, settings);
+    return result;
+}
+
+//==============================================================================
+void ImageAdjuster::apply (const juce::Image& src, juce::Image& dst, const Settings& settings)
+{
+    if (src.isNull())
+    {
+        dst = {};
+        return;
+    }
+
+    const auto width = src.getWidth();
+    const auto height = src.getHeight();
+    const auto format = src.getFormat();
+
+    if (settings.isIdentity() || (format != juce::Image::ARGB && format != juce::Image::RGB))
+    {
+        if (dst != src)
+            dst = src.createCopy();
+
+        return;
+    }
+
+    if (dst.isNull() || dst.getWidth() != width || dst.getHeight() != height || dst.getFormat() != format)
+        dst = juce::Image (format, width, height, false);
+
+    const auto inPlace = dst == src;
+
+    juce::Image::BitmapData srcData (src, juce::Image::BitmapData::readOnly);
+    juce::Image::BitmapData dstData (dst, inPlace ? juce::Image::BitmapData::readWrite
+                                                  : juce::Image::BitmapData::writeOnly);
+
+    const auto tint = settings.tint.getHSB();
+    const auto hasAlpha = format == juce::Image::ARGB;
+
+    juce::SharedResourcePointer<WorkerPool> workers;
+
+    workers->parallelFor (height, juce::jmax (1, 16384 / width), [&] (int begin, int end)
+    {
+        std::vector<float> channels ((size_t) width * 4);
+
+        auto* r = channels.data();
+        auto* g = r + width;
+        auto* b = g + width;
+        auto* a = b + width;
+
+        for (int y = begin; y < end; ++y)
+        {
+            auto* in = srcData.getLinePointer (y);
+            auto* out = dstData.getLinePointer (y);
+
+            if (hasAlpha)
+            {
+                for (int x = 0; x < width; ++x)
+                {
+                    auto* p = (const juce::PixelARGB*) (in + x * srcData.pixelStride);
+                    auto alpha = p->getAlpha();
+                    auto unpremultiply = alpha > 0 ? 1.0f / float (alpha) : 0.0f;
+
+                    a[x] = float (alpha) / 255.0f;
+                    r[x] = float (p->getRed()) * unpremultiply;
+                    g[x] = float (p->getGreen()) * unpremultiply;
+                    b[x] = float (p->getBlue()) * unpremultiply;
+                }
+
+                adjustRow (r, g, b, width, settings, tint);
+
+                for (int x = 0; x < width; ++x)
+                {
+                    auto alpha = a[x] * 255.0f;
+
+                    ((juce::PixelARGB*) (out + x * dstData.pixelStride))
+                        ->setARGB (juce::uint8 (alpha + 0.5f),
+                                   juce::uint8 (r[x] * alpha + 0.5f),
+                                   juce::uint8 (g[x] * alpha + 0.5f),
+                                   juce::uint8 (b[x] * alpha + 0.5f));
+                }
+            }
+            else
+            {
+                for (int x = 0; x < width; ++x)
+                {
+                    auto* p = (const juce::PixelRGB*) (in + x * srcData.pixelStride);
+
+                    r[x] = float (p->getRed()) / 255.0f;
+                    g[x] = float (p->getGreen()) / 255.0f;
+                    b[x] = float (p->getBlue()) / 255.0f;
+                }
+
+                adjustRow (r, g, b, width, settings, tint);
+
+                for (int x = 0; x < width; ++x)
+                {
+                    auto* p = (juce::PixelRGB*) (out + x * dstData.pixelStride);
+
+                    p->setARGB (255,
+                                juce::uint8 (r[x] * 255.0f + 0.5f),
+                                juce::uint8 (g[x] * 255.0f + 0.5f),
+                                juce::uint8 (b[x] * 255.0f + 0.5f));
+                }
+            }
+        }
+    });
+}
+
+} // namespace reFX
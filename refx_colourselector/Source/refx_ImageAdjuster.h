@@ -0,0 +1,84 @@
+#pragma once
+
+namespace reFX
+{
+
+//==============================================================================
+/**
+    Recolours whole images: hue rotation, saturation and brightness scaling,
+    and tinting towards a colour.
+
+    The pixels are unpremultiplied, adjusted in HSB with the batch DeepColour
+    conversions, and premultiplied again, so semi-transparent edges keep their
+    colour. Rows are processed in parallel on the shared WorkerPool.
+
+    For live editing, give the adjuster a source image once, call getPreview()
+    while the settings change, which works on a downscaled copy, and call
+    commit() for the full resolution result.
+
+    @tags{Graphics}
+*/
+class ImageAdjuster
+{
+public:
+    //==============================================================================
+    struct Settings
+    {
+        /** Added to the hue, in turns. 0.5 rotates the hue halfway around the circle. */
+        float hueShift = 0.0f;
+
+        /** Multiplies the saturation. */
+        float saturation = 1.0f;
+
+        /** Multiplies the brightness. */
+        float brightness = 1.0f;
+
+        /** The colour to tint towards. Its hue and saturation replace those of the
+            pixels, which keep their brightness.
+        */
+        DeepColour tint;
+
+        /** How far to tint, between 0.0 and 1.0. */
+        float tintAmount = 0.0f;
+
+        /** Returns true if these settings leave every pixel unchanged. */
+        bool isIdentity() const noexcept;
+    };
+
+    //==============================================================================
+    /** Creates an adjuster without a source image. */
+    ImageAdjuster() = default;
+
+    /** Creates an adjuster for an image. */
+    explicit ImageAdjuster (const juce::Image& source, int maxPreviewSize = 512);
+
+    /** Sets the image to adjust. The preview is a copy scaled to fit within maxPreviewSize pixels. */
+    void setSource (const juce::Image& source, int maxPreviewSize = 512);
+
+    /** Returns the image being adjusted. */
+    const juce::Image& getSource() const noexcept       { return source; }
+
+    /** Adjusts the downscaled copy of the source. The returned image is reused by
+        the next call, so copy it if it needs to outlive that.
+    */
+    const juce::Image& getPreview (const Settings& settings);
+
+    /** Returns an adjusted copy of the source at full resolution. */
+    juce::Image commit (const Settings& settings) const;
+
+    //==============================================================================
+    /** Adjusts an image. The destination is reallocated if it doesn't match the
+        source in size and format, and can share its pixels with the source to
+        adjust it in place. RGB and ARGB images are supported, other formats are
+        copied unchanged.
+    */
+    static void apply (const juce::Image& source, juce::Image& destination, const Settings& settings);
+
+private:
+    //==============================================================================
+    juce::Image source, proxy, preview;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ImageAdjuster)
+};
+
+} // namespace reFX
@@ -0,0 +1,337 @@
+namespace reFX
+{
+
+//==============================================================================
+SummedAreaTable::SummedAreaTable (const juce::Image& source, std::function<bool()> shouldExit)
+{
+    if (! source.isValid())
+        return;
+
+    auto argb = source.convertedToFormat (juce::Image::ARGB);
+    juce::Image::BitmapData pixels (argb, juce::Image::BitmapData::readOnly);
+
+    auto w = argb.getWidth();
+    auto h = argb.getHeight();
+    auto stride = size_t (w + 1) * 4;
+
+    sums.assign (stride * size_t (h + 1), 0);
+
+    for (int y = 0; y < h; ++y)
+    {
+        if (shouldExit && shouldExit())
+        {
+            sums = {};
+            return;
+        }
+
+        auto* above = sums.data() + size_t (y) * stride;
+        auto* row   = above + stride;
+
+        juce::uint32 rowSum[4] = {};
+
+        for (int x = 0; x < w; ++x)
+        {
+            auto* p = reinterpret_cast<const juce::PixelARGB*> (pixels.getPixelPointer (x, y));
+
+            rowSum[0] += p->getAlpha();
+            rowSum[1] += p->getRed();
+            rowSum[2] += p->getGreen();
+            rowSum[3] += p->getBlue();
+
+            for (int c = 0; c < 4; ++c)
+                row[(x + 1) * 4 + c] = above[(x + 1) * 4 + c] + rowSum[c];
+        }
+    }
+
+    width = w;
+    height = h;
+}
+
+DeepColour SummedAreaTable::getAverage (juce::Rectangle<int> area) const noexcept
+{
+    area = area.getIntersection ({ width, height });
+
+    if (area.isEmpty())
+        return {};
+
+    auto stride = size_t (width + 1) * 4;
+    auto* top    = sums.data() + size_t (area.getY()) * stride;
+    auto* bottom = sums.data() + size_t (area.getBottom()) * stride;
+    auto left  = size_t (area.getX()) * 4;
+    auto right = size_t (area.getRight()) * 4;
+
+    // unsigned arithmetic wraps, so the differences are exact even if the sums overflowed
+    float total[4];
+    for (int c = 0; c < 4; ++c)
+        total[c] = float (bottom[right + c] - bottom[left + c] - top[right + c] + top[left + c]);
+
+    auto scale = 1.0f / (255.0f * float (area.getWidth()) * float (area.getHeight()));
+    auto alpha = total[0] * scale;
+
+    if (alpha <= 0.0f)
+        return {};
+
+    // the table holds premultiplied values
+    auto unpremultiply = scale / alpha;
+
+    return DeepColour::fromRGBA (juce::jlimit (0.0f, 1.0f, total[1] * unpremultiply),
+                                 juce::jlimit (0.0f, 1.0f, total[2] * unpremultiply),
+                                 juce::jlimit (0.0f, 1.0f, total[3] * unpremultiply),
+                                 juce::jlimit (0.0f, 1.0f, alpha));
+}
+
+//==============================================================================
+class ImageEyedropper::BuildJob  : public juce::ThreadPoolJob
+{
+public:
+    BuildJob (ImageEyedropper& e, const juce::Image& img)
+        : juce::ThreadPoolJob ("SummedAreaTable"), owner (e), image (img)
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        auto result = std::make_shared<const SummedAreaTable> (image, [this] { return shouldExit(); });
+
+        if (! shouldExit() && ! result->isEmpty())
+            owner.tableBuilt (image, std::move (result));
+
+        return jobHasFinished;
+    }
+
+    bool isFor (const ImageEyedropper& e) const noexcept    { return &owner == &e; }
+
+private:
+    ImageEyedropper& owner;
+    juce::Image image;
+};
+
+//==============================================================================
+ImageEyedropper::ImageEyedropper (ColourSelector& cs)
+    : owner (cs)
+{
+}
+
+ImageEyedropper::~ImageEyedropper()
+{
+    setTarget (nullptr);
+    cancelBuild();
+}
+
+void ImageEyedropper::setImage (const juce::Image& newImage, juce::Component* newTarget)
+{
+    setTarget (newTarget);
+
+    // the same pixel data can keep its table
+    if (newImage != image)
+        rebuildTable (newImage);
+}
+
+void ImageEyedropper::setComponent (juce::Component* newTarget)
+{
+    setTarget (newTarget);
+
+    if (newTarget == nullptr || newTarget->getLocalBounds().isEmpty())
+    {
+        rebuildTable ({});
+        return;
+    }
+
+    auto scale = juce::Component::getApproximateScaleFactorForComponent (newTarget);
+    rebuildTable (newTarget->createComponentSnapshot (newTarget->getLocalBounds(), true, scale));
+}
+
+void ImageEyedropper::imageChanged()
+{
+    rebuildTable (image);
+}
+
+void ImageEyedropper::setTarget (juce::Component* newTarget)
+{
+    if (target.getComponent() == newTarget)
+        return;
+
+    if (target != nullptr)
+        target->removeMouseListener (this);
+
+    target = newTarget;
+
+    if (target != nullptr)
+        target->addMouseListener (this, true);
+}
+
+void ImageEyedropper::rebuildTable (const juce::Image& newImage)
+{
+    cancelBuild();
+
+    {
+        const juce::ScopedLock sl (tableLock);
+        image = newImage;
+        table.reset();
+    }
+
+    if (image.isValid())
+        workers->getThreadPool().addJob (new BuildJob (*this, image), true);
+}
+
+void ImageEyedropper::cancelBuild()
+{
+    // the pool is shared, so only this eyedropper's job is removed
+    struct OwnJob  : public juce::ThreadPool::JobSelector
+    {
+        explicit OwnJob (const ImageEyedropper& e) : eyedropper (e) {}
+
+        bool isJobSuitable (juce::ThreadPoolJob* job) override
+        {
+            auto* build = dynamic_cast<BuildJob*> (job);
+            return build != nullptr && build->isFor (eyedropper);
+        }
+
+        const ImageEyedropper& eyedropper;
+    };
+
+    OwnJob selector (*this);
+    workers->getThreadPool().removeAllJobs (true, -1, &selector);
+}
+
+void ImageEyedropper::tableBuilt (const juce::Image& source, std::shared_ptr<const SummedAreaTable> newTable)
+{
+    const juce::ScopedLock sl (tableLock);
+
+    // a table for an image that has since been replaced is of no use
+    if (source == image)
+        table = std::move (newTable);
+}
+
+//==============================================================================
+void ImageEyedropper::setKernelSize (int newSize)
+{
+    kernelSize = juce::jmax (1, newSize);
+}
+
+void ImageEyedropper::setActive (bool shouldBeActive)
+{
+    active = shouldBeActive;
+
+    if (! active)
+        dragging = false;
+}
+
+juce::Rectangle<int> ImageEyedropper::getKernelArea (juce::Point<int> centre) const
+{
+    return { centre.x - kernelSize / 2, centre.y - kernelSize / 2, kernelSize, kernelSize };
+}
+
+DeepColour ImageEyedropper::sample (juce::Point<int> imagePosition) const
+{
+    auto area = getKernelArea (imagePosition);
+
+    std::shared_ptr<const SummedAreaTable> current;
+
+    {
+        const juce::ScopedLock sl (tableLock);
+        current = table;
+    }
+
+    if (current != nullptr)
+        return current->getAverage (area);
+
+    return sampleDirect (area);
+}
+
+DeepColour ImageEyedropper::sampleDirect (juce::Rectangle<int> area) const
+{
+    area = area.getIntersection (image.getBounds());
+
+    if (area.isEmpty())
+        return {};
+
+    juce::Image::BitmapData pixels (image, area.getX(), area.getY(), area.getWidth(), area.getHeight(), juce::Image::BitmapData::readOnly);
+
+    float total[4] = {};
+
+    for (int y = 0; y < area.getHeight(); ++y)
+    {
+        for (int x = 0; x < area.getWidth(); ++x)
+        {
+            auto c = pixels.getPixelColour (x, y);
+            auto alpha = c.getFloatAlpha();
+
+            total[0] += alpha;
+            total[1] += c.getFloatRed() * alpha;
+            total[2] += c.getFloatGreen() * alpha;
+            total[3] += c.getFloatBlue() * alpha;
+        }
+    }
+
+    if (total[0] <= 0.0f)
+        return {};
+
+    return DeepColour::fromRGBA (total[1] / total[0],
+                                 total[2] / total[0],
+                                 total[3] / total[0],
+                                 total[0] / float (area.getWidth() * area.getHeight()));
+}
+
+std::optional<juce::Point<int>> ImageEyedropper::getImagePosition (const juce::MouseEvent& e) const
+{
+    if (target == nullptr || ! image.isValid() || target->getLocalBounds().isEmpty())
+        return {};
+
+    auto pos = e.getEventRelativeTo (target.getComponent()).position;
+
+    if (! target->getLocalBounds().toFloat().contains (pos))
+        return {};
+
+    return juce::Point<int> (int (pos.x * float (image.getWidth())  / float (target->getWidth())),
+                             int (pos.y * float (image.getHeight()) / float (target->getHeight())));
+}
+
+void ImageEyedropper::showSample (const juce::MouseEvent& e)
+{
+    if (auto pos = getImagePosition (e))
+    {
+        auto c = sample (*pos);
+        lastSample = c;
+        owner.setCurrentColour ((owner.getFlags() & ColourSelector::showAlphaChannel) != 0 ? c : c.withAlpha (1.0f));
+    }
+}
+
+void ImageEyedropper::mouseMove (const juce::MouseEvent& e)
+{
+    if (active)
+        showSample (e);
+}
+
+void ImageEyedropper::mouseDown (const juce::MouseEvent& e)
+{
+    if (! active || ! getImagePosition (e))
+        return;
+
+    dragging = true;
+    showSample (e);
+}
+
+void ImageEyedropper::mouseDrag (const juce::MouseEvent& e)
+{
+    if (dragging)
+        showSample (e);
+}
+
+void ImageEyedropper::mouseUp (const juce::MouseEvent& e)
+{
+    if (! dragging)
+        return;
+
+    dragging = false;
+    active = false;
+
+    // released outside the image, the last colour sampled inside it is picked
+    auto pos = getImagePosition (e);
+    auto picked = pos ? sample (*pos) : lastSample;
+
+    if (onColourPicked != nullptr)
+        onColourPicked (picked);
+}
+
+} // namespace reFX
@@ -0,0 +1,151 @@
+#pragma once
+
+namespace reFX
+{
+
+//==============================================================================
+/**
+    A summed-area table of an image's premultiplied ARGB channels.
+
+    Once the table is built, the average colour of any rectangle of the image
+    can be read in constant time, regardless of the size of the rectangle.
+
+    The sums are stored modulo 2^32, which keeps the table at 16 bytes per pixel
+    and is still exact for any rectangle of up to 16 million pixels.
+
+    @tags{Graphics}
+*/
+class SummedAreaTable
+{
+public:
+    //==============================================================================
+    /** Creates an empty table. */
+    SummedAreaTable() = default;
+
+    /** Builds the table for an image.
+
+        If shouldExit is given, it is polled between rows and an empty table is
+        returned as soon as it returns true.
+    */
+    explicit SummedAreaTable (const juce::Image& image, std::function<bool()> shouldExit = {});
+
+    //==============================================================================
+    /** Returns true if the table has not been built. */
+    bool isEmpty() const noexcept                       { return width == 0 || height == 0; }
+
+    int getWidth() const noexcept                       { return width; }
+    int getHeight() const noexcept                      { return height; }
+
+    /** Returns the average colour of an area of the image.
+
+        The area is clipped to the image bounds. If nothing is left, a
+        transparent colour is returned.
+    */
+    DeepColour getAverage (juce::Rectangle<int> area) const noexcept;
+
+private:
+    //==============================================================================
+    int width = 0;
+    int height = 0;
+
+    // (width + 1) * (height + 1) entries of 4 channels, with a leading row and column of zeros
+    std::vector<juce::uint32> sums;
+
+    JUCE_LEAK_DETECTOR (SummedAreaTable)
+};
+
+//==============================================================================
+/**
+    Lets the user pick colours for a ColourSelector from an image, or from a
+    snapshot of a component, by hovering over it.
+
+    While active, the colour under the mouse is averaged over an NxN kernel and
+    sent to the selector live, also while the mouse is dragged across the image.
+    Releasing the button picks the colour and deactivates the eyedropper.
+
+    The summed-area table for the image is built on the shared WorkerPool and kept
+    until a different image is set or imageChanged() is called. Until it is
+    ready, samples are averaged directly from the image.
+
+    @tags{GUI}
+*/
+class ImageEyedropper : private juce::MouseListener
+{
+public:
+    //==============================================================================
+    /** Creates an eyedropper that drives the given selector. */
+    explicit ImageEyedropper (ColourSelector& selector);
+
+    /** Destructor. */
+    ~ImageEyedropper() override;
+
+    //==============================================================================
+    /** Samples an image while the mouse hovers over the target component.
+
+        The image is stretched over the target's local bounds.
+    */
+    void setImage (const juce::Image& image, juce::Component* target);
+
+    /** Samples a snapshot of a component while the mouse hovers over it.
+
+        The snapshot is taken at the component's current scale. Call this again
+        to take a new snapshot after the component has changed.
+    */
+    void setComponent (juce::Component* target);
+
+    /** Call this if the pixels of the current image have been modified in place. */
+    void imageChanged();
+
+    //==============================================================================
+    /** Sets the size of the square area that is averaged for each sample. */
+    void setKernelSize (int newSize);
+
+    /** Returns the size of the square area that is averaged for each sample. */
+    int getKernelSize() const noexcept                  { return kernelSize; }
+
+    /** Starts or stops driving the selector while hovering. */
+    void setActive (bool shouldBeActive);
+
+    /** Returns true if the selector is driven while hovering. */
+    bool isActive() const noexcept                      { return active; }
+
+    /** Returns the average colour around a position in image coordinates. */
+    DeepColour sample (juce::Point<int> imagePosition) const;
+
+    /** Called when the user releases the mouse to pick the colour under it. */
+    std::function<void (const DeepColour&)> onColourPicked;
+
+private:
+    //==============================================================================
+    class BuildJob;
+
+    ColourSelector& owner;
+    juce::Component::SafePointer<juce::Component> target;
+    juce::Image image;
+    std::shared_ptr<const SummedAreaTable> table;
+    mutable juce::CriticalSection tableLock;
+    juce::SharedResourcePointer<WorkerPool> workers;
+    int kernelSize = 1;
+    bool active = false;
+    bool dragging = false;
+    DeepColour lastSample;
+
+    void setTarget (juce::Component*);
+    void rebuildTable (const juce::Image&);
+    void cancelBuild();
+    void tableBuilt (const juce::Image&, std::shared_ptr<const SummedAreaTable>);
+    DeepColour sampleDirect (juce::Rectangle<int>) const;
+    juce::Rectangle<int> getKernelArea (juce::Point<int>) const;
+    std::optional<juce::Point<int>> getImagePosition (const juce::MouseEvent&) const;
+
+    void showSample (const juce::MouseEvent&);
+
+    void mouseMove (const juce::MouseEvent&) override;
+    void mouseDown (const juce::MouseEvent&) override;
+    void mouseDrag (const juce::MouseEvent&) override;
+    void mouseUp (const juce::MouseEvent&) override;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ImageEyedropper)
+};
+
+} // namespace reFX
@@ -0,0 +1,55 @@
+#pragma once
+
+namespace reFX
+{
+
+//==============================================================================
+/**
+    The CSS named colours, which are the X11 colour names as CSS adopted them.
+    Where the two differ, such as for green, the CSS colour is used.
+
+    Names are found through a perfect hash table that is built at compile time,
+    so a lookup hashes the name twice and compares it with a single entry. Case,
+    spaces, hyphens and underscores are ignored, so "Rebecca Purple" finds
+    rebeccapurple.
+
+    @tags{Graphics}
+*/
+class NamedColours
+{
+public:
+    //==============================================================================
+    /** Returns the colour with a name, or nothing if no colour has that name. */
+    static std::optional<juce::Colour> find (juce::StringRef name) noexcept;
+
+    /** A named colour, and how far it is from the colour that was looked up. */
+    struct Match
+    {
+        juce::String name;
+        juce::Colour colour;
+
+        /** The OKLab difference, where about 0.02 is just noticeable. */
+        float difference = 0.0f;
+    };
+
+    /** Returns the named colour closest to a colour in OKLab, ignoring alpha.
+
+        Where colours have two names, such as grey and gray, the first one in
+        alphabetical order is returned.
+    */
+    static Match findNearest (const DeepColour& colour);
+
+    /** Returns a name to show for a colour: its own name if it has one, or the
+        nearest name with a leading "~" if that is within a difference. Otherwise
+        returns an empty string.
+    */
+    static juce::String getDisplayName (const DeepColour& colour, float maxDifference = 0.05f);
+
+    /** Returns the number of names. */
+    static int getNumNames() noexcept;
+
+    /** The length of the longest name, which text editors can use as a limit. */
+    static constexpr int maxNameLength = 20;
+};
+
+} // namespace reFX
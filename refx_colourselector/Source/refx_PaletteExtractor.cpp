@@ -0,0 +1,243 @@
+namespace reFX
+{
+
+//==============================================================================
+namespace
+{
+    constexpr int paletteBlockSize = 256;
+
+    /** Finds the closest centre for each point.
+
+        The points are processed in blocks, with the loop over a block innermost
+        and free of branches, so that the compiler can vectorise it.
+    */
+    void findNearestCentres (const float* L, const float* A, const float* B, int num,
+                             const std::vector<OKLab>& centres, int* nearest) noexcept
+    {
+        float best[paletteBlockSize];
+
+        for (int start = 0; start < num; start += paletteBlockSize)
+        {
+            auto count = juce::jmin (paletteBlockSize, num - start);
+            auto* l = L + start;
+            auto* a = A + start;
+            auto* b = B + start;
+            auto* n = nearest + start;
+
+            std::fill (best, best + count, std::numeric_limits<float>::max());
+
+            for (int j = 0; j < int (centres.size()); ++j)
+            {
+                auto c = centres[size_t (j)];
+
+                for (int i = 0; i < count; ++i)
+                {
+                    auto dL = l[i] - c.L;
+                    auto da = a[i] - c.a;
+                    auto db = b[i] - c.b;
+                    auto d = dL * dL + da * da + db * db;
+
+                    auto closer = d < best[i];
+                    best[i] = closer ? d : best[i];
+                    n[i]    = closer ? j : n[i];
+                }
+            }
+        }
+    }
+
+    float squaredDistance (const OKLab& x, const OKLab& y) noexcept
+    {
+        auto dL = x.L - y.L;
+        auto da = x.a - y.a;
+        auto db = x.b - y.b;
+        return dL * dL + da * da + db * db;
+    }
+}
+
+//==============================================================================
+std::vector<PaletteExtractor::Entry> PaletteExtractor::extract (const juce::Image& image)
+{
+    return extract (image, Options());
+}
+
+std::vector<PaletteExtractor::Entry> PaletteExtractor::extract (const juce::Image& image, const Options& options)
+{
+    if (! image.isValid() || options.numColours <= 0)
+        return {};
+
+    juce::SharedResourcePointer<WorkerPool> workers;
+
+    //==============================================================================
+    // Sample the image on a regular grid and convert the samples to OKLab
+    auto width  = image.getWidth();
+    auto height = image.getHeight();
+    auto step   = juce::jmax (1, int (std::ceil (std::sqrt (double (width) * double (height) / double (juce::jmax (1, options.maxSamples))))));
+    auto cols   = (width  + step - 1) / step;
+    auto rows   = (height + step - 1) / step;
+    auto total  = cols * rows;
+
+    std::vector<float> L ((size_t) total), A ((size_t) total), B ((size_t) total);
+    std::vector<juce::uint8> used ((size_t) total);
+
+    {
+        const juce::Image::BitmapData pixels (image, juce::Image::BitmapData::readOnly);
+        auto minAlpha = juce::uint8 (juce::jlimit (0, 255, juce::roundToInt (options.minAlpha * 255.0f)));
+
+        workers->parallelFor (rows, 8, [&] (int begin, int end)
+        {
+            for (int row = begin; row < end; ++row)
+            {
+                for (int col = 0; col < cols; ++col)
+                {
+                    auto i = size_t (row * cols + col);
+                    auto c = pixels.getPixelColour (col * step, row * step);
+
+                    auto lab = linearRgbToOklab (srgb8ToLinear (c.getRed()),
+                                                 srgb8ToLinear (c.getGreen()),
+                                                 srgb8ToLinear (c.getBlue()));
+                    L[i] = lab.L;
+                    A[i] = lab.a;
+                    B[i] = lab.b;
+                    used[i] = juce::uint8 (c.getAlpha() >= minAlpha ? 1 : 0);
+                }
+            }
+        });
+    }
+
+    int num = 0;
+
+    for (int i = 0; i < total; ++i)
+    {
+        if (used[size_t (i)] != 0)
+        {
+            L[size_t (num)] = L[size_t (i)];
+            A[size_t (num)] = A[size_t (i)];
+            B[size_t (num)] = B[size_t (i)];
+            ++num;
+        }
+    }
+
+    if (num == 0)
+        return {};
+
+    auto k = juce::jmin (options.numColours, num);
+
+    //==============================================================================
+    // k-means++ seeding, with a fixed seed so that the same image gives the same palette
+    juce::Random random (0x5eed);
+    std::vector<OKLab> centres;
+    std::vector<float> distances ((size_t) num, std::numeric_limits<float>::max());
+
+    centres.emplace_back (L[0], A[0], B[0]);
+
+    while (int (centres.size()) < k)
+    {
+        double sum = 0.0;
+
+        for (int i = 0; i < num; ++i)
+        {
+            auto& d = distances[size_t (i)];
+            d = juce::jmin (d, squaredDistance ({ L[size_t (i)], A[size_t (i)], B[size_t (i)] }, centres.back()));
+            sum += d;
+        }
+
+        // every remaining sample sits on a centre already
+        if (sum <= 0.0)
+            break;
+
+        auto target = random.nextDouble() * sum;
+        auto chosen = num - 1;
+
+        for (int i = 0; i < num; ++i)
+        {
+            target -= distances[size_t (i)];
+
+            if (target <= 0.0)
+            {
+                chosen = i;
+                break;
+            }
+        }
+
+        centres.emplace_back (L[size_t (chosen)], A[size_t (chosen)], B[size_t (chosen)]);
+    }
+
+    k = int (centres.size());
+
+    //==============================================================================
+    // Lloyd iterations, accumulating per-chunk sums that are merged under a lock
+    std::vector<int> nearest ((size_t) num, 0);
+    std::vector<double> sums ((size_t) k * 3);
+    std::vector<int> counts ((size_t) k);
+    juce::SpinLock sumLock;
+
+    auto tolerance = options.tolerance * options.tolerance;
+
+    for (int iteration = 0; iteration < juce::jmax (1, options.maxIterations); ++iteration)
+    {
+        std::fill (sums.begin(), sums.end(), 0.0);
+        std::fill (counts.begin(), counts.end(), 0);
+
+        workers->parallelFor (num, 4096, [&] (int begin, int end)
+        {
+            findNearestCentres (L.data() + begin, A.data() + begin, B.data() + begin, end - begin,
+                                centres, nearest.data() + begin);
+
+            std::vector<double> localSums ((size_t) k * 3, 0.0);
+            std::vector<int> localCounts ((size_t) k, 0);
+
+            for (int i = begin; i < end; ++i)
+            {
+                auto j = size_t (nearest[size_t (i)]);
+                localSums[j * 3 + 0] += L[size_t (i)];
+                localSums[j * 3 + 1] += A[size_t (i)];
+                localSums[j * 3 + 2] += B[size_t (i)];
+                localCounts[j]++;
+            }
+
+            const juce::SpinLock::ScopedLockType sl (sumLock);
+
+            for (size_t j = 0; j < size_t (k); ++j)
+            {
+                sums[j * 3 + 0] += localSums[j * 3 + 0];
+                sums[j * 3 + 1] += localSums[j * 3 + 1];
+                sums[j * 3 + 2] += localSums[j * 3 + 2];
+                counts[j] += localCounts[j];
+            }
+        });
+
+        auto maxShift = 0.0f;
+
+        for (size_t j = 0; j < size_t (k); ++j)
+        {
+            if (counts[j] == 0)
+                continue;
+
+            OKLab moved (float (sums[j * 3 + 0] / counts[j]),
+                         float (sums[j * 3 + 1] / counts[j]),
+                         float (sums[j * 3 + 2] / counts[j]));
+
+            maxShift = juce::jmax (maxShift, squaredDistance (moved, centres[j]));
+            centres[j] = moved;
+        }
+
+        if (maxShift <= tolerance)
+            break;
+    }
+
+    //==============================================================================
+    std::vector<Entry> palette;
+
+    for (size_t j = 0; j < size_t (k); ++j)
+        if (counts[j] > 0)
+            palette.push_back ({ DeepColour::fromOKLab (centres[j]), float (counts[j]) / float (num) });
+
+    std::stable_sort (palette.begin(), palette.end(), [] (const Entry& x, const Entry& y)
+    {
+        return x.coverage > y.coverage;
+    });
+
+    return palette;
+}
+
+} // namespace reFX
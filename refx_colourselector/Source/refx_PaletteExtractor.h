@@ -0,0 +1,57 @@
+#pragma once
+
+namespace reFX
+{
+
+//==============================================================================
+/**
+    Finds the dominant colours of an image.
+
+    The image is subsampled on a regular grid, converted to OKLab, and clustered
+    with k-means on the shared WorkerPool. Iteration stops early once no
+    cluster centre moves by more than the tolerance.
+
+    @tags{Graphics}
+*/
+class PaletteExtractor
+{
+public:
+    //==============================================================================
+    struct Options
+    {
+        /** The number of colours to find. */
+        int numColours = 8;
+
+        /** The image is subsampled down to roughly this many pixels. */
+        int maxSamples = 1 << 16;
+
+        /** The maximum number of k-means iterations. */
+        int maxIterations = 24;
+
+        /** Iteration stops once no cluster centre moves further than this, in OKLab units. */
+        float tolerance = 1.0e-3f;
+
+        /** Pixels that are more transparent than this are ignored. */
+        float minAlpha = 0.5f;
+    };
+
+    struct Entry
+    {
+        DeepColour colour;
+
+        /** The proportion of the sampled pixels closest to this colour, between 0.0 and 1.0. */
+        float coverage = 0.0f;
+    };
+
+    /** Returns up to options.numColours colours, ordered by decreasing coverage.
+
+        Fewer colours are returned if the image has fewer distinct colours than
+        requested, or no pixels that are opaque enough.
+    */
+    static std::vector<Entry> extract (const juce::Image& image, const Options& options);
+
+    /** Returns the dominant colours of an image using the default options. */
+    static std::vector<Entry> extract (const juce::Image& image);
+};
+
+} // namespace reFX
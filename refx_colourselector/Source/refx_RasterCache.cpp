@@ -0,0 +1,152 @@
+namespace reFX
+{
+
+//==============================================================================
+juce::Image RasterPool::acquire (juce::Image::PixelFormat format, int width, int height)
+{
+    auto now = juce::Time::getMillisecondCounter();
+
+    {
+        const juce::SpinLock::ScopedLockType sl (lock);
+
+        for (auto& e : entries)
+        {
+            if (e.image.getReferenceCount() == 1 && e.image.getFormat() == format
+                 && e.image.getWidth() == width && e.image.getHeight() == height)
+            {
+                e.lastAcquired = now;
+                return e.image;
+            }
+        }
+    }
+
+    // allocated outside the lock, so other threads aren't kept waiting
+    juce::Image image (format, width, height, false, juce::SoftwareImageType());
+
+    const juce::SpinLock::ScopedLockType sl (lock);
+
+    // when full, an unused image of another size makes way for the new one
+    if ((int) entries.size() >= maxImages)
+    {
+        auto unused = std::find_if (entries.begin(), entries.end(), [] (const Entry& e) { return e.image.getReferenceCount() == 1; });
+
+        if (unused == entries.end())
+            return image;
+
+        entries.erase (unused);
+    }
+
+    entries.push_back ({ image, now });
+    return image;
+}
+
+void RasterPool::releaseUnused (juce::uint32 unusedForMs)
+{
+    auto now = juce::Time::getMillisecondCounter();
+
+    // the images are freed outside the lock
+    std::vector<Entry> released;
+
+    {
+        const juce::SpinLock::ScopedLockType sl (lock);
+
+        for (auto i = entries.size(); i-- > 0;)
+        {
+            if (entries[i].image.getReferenceCount() == 1 && now - entries[i].lastAcquired >= unusedForMs)
+            {
+                released.push_back (std::move (entries[i]));
+                entries.erase (entries.begin() + (std::ptrdiff_t) i);
+            }
+        }
+    }
+}
+
+size_t RasterPool::getUnusedBytes() const
+{
+    const juce::SpinLock::ScopedLockType sl (lock);
+
+    size_t total = 0;
+
+    for (auto& e : entries)
+        if (e.image.getReferenceCount() == 1)
+            total += RasterCache::getImageBytes (e.image);
+
+    return total;
+}
+
+//==============================================================================
+RasterCache::Owner::Owner()
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+    cache->owners.add (this);
+}
+
+RasterCache::Owner::~Owner()
+{
+    cache->owners.removeFirstMatchingValue (this);
+}
+
+//==============================================================================
+RasterCache::RasterCache()
+{
+    startTimer (1000);
+}
+
+RasterCache::~RasterCache()
+{
+    // every owner holds a pointer to the cache, so they must all be gone
+    jassert (owners.isEmpty());
+}
+
+size_t RasterCache::getTotalBytes() const
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    size_t total = 0;
+
+    for (auto* o : owners)
+        total += o->getCacheBytes();
+
+    return total + pool->getUnusedBytes();
+}
+
+void RasterCache::releaseAll()
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    for (auto* o : owners)
+        o->releaseCache();
+
+    pool->releaseUnused();
+}
+
+void RasterCache::releaseHidden()
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    for (auto* o : owners)
+        if (o->getCacheBytes() > 0 && ! o->isCacheShowing())
+            o->releaseCache();
+}
+
+size_t RasterCache::getImageBytes (const juce::Image& image)
+{
+    if (image.isNull())
+        return 0;
+
+    auto bytesPerPixel = image.getFormat() == juce::Image::ARGB ? 4
+                       : image.getFormat() == juce::Image::RGB  ? 3
+                                                                : 1;
+
+    return size_t (image.getWidth()) * size_t (image.getHeight()) * size_t (bytesPerPixel);
+}
+
+void RasterCache::timerCallback()
+{
+    releaseHidden();
+
+    // images that were needed recently are likely to be needed again
+    pool->releaseUnused (5000);
+}
+
+} // namespace reFX
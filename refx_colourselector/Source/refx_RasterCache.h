@@ -0,0 +1,125 @@
+#pragma once
+
+namespace reFX
+{
+
+//==============================================================================
+/**
+    Hands out software images to render into, and takes them back once they are
+    no longer used.
+
+    An image is free again when the pool holds the only reference to it. So a
+    render that replaces the image a component shows reuses an earlier one, and
+    a drag that renders one image after another stops allocating once the pool
+    holds an image of each size in use.
+
+    All functions can be called from any thread.
+
+    @tags{GUI}
+*/
+class RasterPool
+{
+public:
+    //==============================================================================
+    RasterPool() = default;
+
+    /** Returns an image of the format and size that nobody else uses. Its pixels are undefined. */
+    juce::Image acquire (juce::Image::PixelFormat format, int width, int height);
+
+    /** Drops the images that nobody uses and that haven't been handed out for a while. */
+    void releaseUnused (juce::uint32 unusedForMs = 0);
+
+    /** Returns the number of bytes used by the images that nobody else uses. */
+    size_t getUnusedBytes() const;
+
+private:
+    //==============================================================================
+    struct Entry
+    {
+        juce::Image image;
+        juce::uint32 lastAcquired = 0;
+    };
+
+    static constexpr int maxImages = 16;
+
+    mutable juce::SpinLock lock;
+    std::vector<Entry> entries;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RasterPool)
+};
+
+//==============================================================================
+/**
+    Keeps track of the images that the components of this module cache.
+
+    Every component with a raster cache is an Owner. Once a second, caches whose
+    components aren't showing, for example because they are in a hidden tab, a
+    closed popup or a minimised window, are released. The components render
+    their images again when they are next painted.
+
+    It also holds the RasterPool that the images are rendered into.
+
+    Get hold of it with a juce::SharedResourcePointer<RasterCache>, or use the
+    static functions of ColourSelector.
+
+    @tags{GUI}
+*/
+class RasterCache  : private juce::Timer
+{
+public:
+    //==============================================================================
+    /** A component that caches rendered images. */
+    class Owner
+    {
+    public:
+        Owner();
+        virtual ~Owner();
+
+        /** Returns the number of bytes used by the cached images. */
+        virtual size_t getCacheBytes() const = 0;
+
+        /** Drops the cached images, and any renders of them that are pending. */
+        virtual void releaseCache() = 0;
+
+        /** Returns true if the cached images are currently on screen. */
+        virtual bool isCacheShowing() const = 0;
+
+    protected:
+        /** Returns the pool to render images into. Render jobs can keep it alive. */
+        std::shared_ptr<RasterPool> getRasterPool() const   { return cache->pool; }
+
+    private:
+        juce::SharedResourcePointer<RasterCache> cache;
+
+        JUCE_DECLARE_NON_COPYABLE (Owner)
+    };
+
+    //==============================================================================
+    RasterCache();
+    ~RasterCache() override;
+
+    /** Returns the number of bytes used by all the cached images. */
+    size_t getTotalBytes() const;
+
+    /** Releases every cache and the pooled images, for example when the system is low on memory. */
+    void releaseAll();
+
+    /** Releases the caches of the components that aren't showing. */
+    void releaseHidden();
+
+    /** Returns the approximate number of bytes used by an image's pixels. */
+    static size_t getImageBytes (const juce::Image& image);
+
+private:
+    //==============================================================================
+    juce::Array<Owner*> owners;
+
+    // shared with the render jobs, which can outlive the cache
+    std::shared_ptr<RasterPool> pool = std::make_shared<RasterPool>();
+
+    void timerCallback() override;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RasterCache)
+};
+
+} // namespace reFX
@@ -0,0 +1,68 @@
+namespace reFX
+{
+
+namespace
+{
+    /** Moves an estimate towards a measurement: quickly when it is higher, so a
+        slow frame is corrected straight away, and slowly when it is lower.
+    */
+    void follow (std::atomic<double>& estimate, double measured)
+    {
+        auto current = estimate.load();
+        auto weight = measured > current ? 0.5 : 0.1;
+        estimate.store (current + (measured - current) * weight);
+    }
+}
+
+//==============================================================================
+void RenderQualityGovernor::setSettings (const Settings& newSettings)
+{
+    jassert (newSettings.minQuality > 0.0f && newSettings.minQuality <= newSettings.maxQuality);
+
+    const juce::SpinLock::ScopedLockType sl (lock);
+    settings = newSettings;
+}
+
+RenderQualityGovernor::Settings RenderQualityGovernor::getSettings() const
+{
+    const juce::SpinLock::ScopedLockType sl (lock);
+    return settings;
+}
+
+float RenderQualityGovernor::getQuality (int numPixels, bool interacting) const
+{
+    auto s = getSettings();
+
+    if (! interacting || numPixels <= 0)
+        return s.maxQuality;
+
+    // drawing takes the same time at any quality, so the render gets what is left
+    auto renderBudget = s.frameBudgetMs - drawCostPerPixel.load() * double (numPixels);
+
+    // the cost grows with the area, so with the square of the quality
+    auto affordable = juce::jmax (0.0, renderBudget) / (costPerPixel.load() * double (numPixels));
+    auto quality = (float) std::sqrt (juce::jmax (0.0, affordable));
+
+    // coarse steps, so that small changes in the measurements don't change the image size
+    quality = std::floor (quality * 16.0f) / 16.0f;
+
+    return juce::jlimit (s.minQuality, s.maxQuality, quality);
+}
+
+void RenderQualityGovernor::addMeasurement (int numPixels, double milliseconds)
+{
+    ++numMeasurements;
+
+    if (numPixels <= 0)
+        return;
+
+    follow (costPerPixel, milliseconds / double (numPixels));
+}
+
+void RenderQualityGovernor::addDrawMeasurement (int numPixels, double milliseconds)
+{
+    if (numPixels > 0)
+        follow (drawCostPerPixel, milliseconds / double (numPixels));
+}
+
+} // namespace reFX
@@ -0,0 +1,83 @@
+#pragma once
+
+namespace reFX
+{
+
+//==============================================================================
+/**
+    Chooses the resolution that a ColourSelector renders its plane and strips at.
+
+    Every render reports how long it took, and the governor keeps a running
+    estimate of the cost per rendered pixel. Drawing the image, which stretches
+    a reduced one to the physical size, is measured as well, and takes the same
+    time at any quality. While the user is dragging the governor picks the highest
+    resolution whose render is expected to fit within what the drawing leaves of
+    the frame budget. Once the input has been idle for a short while, images are
+    rendered again at the maximum quality.
+
+    Images that cost very different amounts per pixel, such as the plane and the
+    strip of a selector, should each have their own governor.
+
+    Measurements can be added from any thread.
+
+    @tags{GUI}
+*/
+class RenderQualityGovernor
+{
+public:
+    //==============================================================================
+    struct Settings
+    {
+        /** The time a render may take during a drag, in milliseconds. */
+        double frameBudgetMs = 4.0;
+
+        /** The lowest resolution used during drags, as a fraction of the physical resolution. */
+        float minQuality = 0.25f;
+
+        /** The resolution used when idle, as a fraction of the physical resolution. */
+        float maxQuality = 1.0f;
+
+        /** How long the input must be idle before rendering at the maximum quality, in milliseconds. */
+        int idleMs = 200;
+    };
+
+    //==============================================================================
+    RenderQualityGovernor() = default;
+
+    void setSettings (const Settings& newSettings);
+    Settings getSettings() const;
+
+    /** Returns the fraction of the physical resolution to render an image of
+        numPixels physical pixels at.
+    */
+    float getQuality (int numPixels, bool interacting) const;
+
+    /** Records how long rendering an image of numPixels rendered pixels took. */
+    void addMeasurement (int numPixels, double milliseconds);
+
+    /** Records how long drawing an image onto numPixels physical pixels took. */
+    void addDrawMeasurement (int numPixels, double milliseconds);
+
+    /** Returns the estimated time to render one pixel, in milliseconds. */
+    double getCostPerPixel() const noexcept             { return costPerPixel.load(); }
+
+    /** Returns the estimated time to draw one physical pixel, in milliseconds. */
+    double getDrawCostPerPixel() const noexcept         { return drawCostPerPixel.load(); }
+
+    /** Returns the number of renders that have been measured. */
+    juce::int64 getNumMeasurements() const noexcept     { return numMeasurements.load(); }
+
+private:
+    //==============================================================================
+    mutable juce::SpinLock lock;
+    Settings settings;
+
+    // a pessimistic guess until the first render has been measured
+    std::atomic<double> costPerPixel { 1.0e-4 };
+    std::atomic<double> drawCostPerPixel { 0.0 };
+    std::atomic<juce::int64> numMeasurements { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RenderQualityGovernor)
+};
+
+} // namespace reFX
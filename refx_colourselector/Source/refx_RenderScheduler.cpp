@@ -0,0 +1,315 @@
+namespace reFX
+{
+
+namespace
+{
+    // how long a worker waits for another request before it gives its thread back
+    // to the pool. Longer than a frame, so a drag keeps its workers.
+    constexpr int workerIdleMs = 250;
+
+    // finished jobs kept for reuse, which is more than are queued at once
+    constexpr size_t maxSpareJobs = 16;
+}
+
+//==============================================================================
+struct RenderScheduler::Job
+{
+    juce::int64 key = 0;
+    Priority priority = Priority::visible;
+    juce::uint64 sequence = 0;
+    RenderFunction render;
+    std::vector<Target*> targets;
+    bool started = false;
+};
+
+//==============================================================================
+struct RenderScheduler::Queue
+{
+    juce::CriticalSection lock;
+    std::vector<std::shared_ptr<Job>> jobs, spareJobs;
+    juce::uint64 nextSequence = 0;
+    int numRunning = 0;
+    int maxRunning = 1;
+    bool shutDown = false;
+
+    // rendered images waiting to be delivered, and the scheduler that delivers them
+    std::vector<std::pair<std::shared_ptr<Job>, juce::Image>> finished;
+    juce::AsyncUpdater* deliverer = nullptr;
+
+    // tells waiting workers that a job was queued, or that the scheduler has gone
+    juce::WaitableEvent jobQueued;
+
+    // only used on the message thread, while delivering. The lists are swapped
+    // rather than copied, so they all keep their capacity.
+    std::vector<std::pair<std::shared_ptr<Job>, juce::Image>> delivering;
+    std::vector<Target*> deliveredTargets;
+
+    Queue()
+    {
+        jobs.reserve (maxSpareJobs);
+        spareJobs.reserve (maxSpareJobs);
+        finished.reserve (maxSpareJobs);
+        delivering.reserve (maxSpareJobs);
+        deliveredTargets.reserve (maxSpareJobs);
+    }
+
+    void submit (Target& target, Priority priority, juce::int64 key, RenderFunction render)
+    {
+        const juce::ScopedLock sl (lock);
+
+        // the same image again, so at most its priority changes
+        if (target.job != nullptr && target.job->key == key)
+        {
+            target.job->priority = juce::jmin (target.job->priority, priority);
+            return;
+        }
+
+        detach (target);
+
+        auto found = std::find_if (jobs.begin(), jobs.end(), [key] (const auto& j) { return j->key == key; });
+
+        if (found != jobs.end())
+        {
+            // another target has asked for the same image, so both get its result
+            target.job = *found;
+            target.job->priority = juce::jmin (target.job->priority, priority);
+        }
+        else
+        {
+            target.job = createJob();
+            target.job->key = key;
+            target.job->priority = priority;
+            target.job->sequence = nextSequence++;
+            target.job->render = std::move (render);
+
+            jobs.push_back (target.job);
+            jobQueued.signal();
+        }
+
+        target.job->targets.push_back (&target);
+    }
+
+    void detach (Target& target)
+    {
+        const juce::ScopedLock sl (lock);
+
+        if (target.job == nullptr)
+            return;
+
+        auto& targets = target.job->targets;
+        targets.erase (std::remove (targets.begin(), targets.end(), &target), targets.end());
+
+        // nobody wants the image any more. A running job can't be stopped, but its result is dropped.
+        if (targets.empty() && ! target.job->started)
+        {
+            jobs.erase (std::remove (jobs.begin(), jobs.end(), target.job), jobs.end());
+            recycle (target.job);
+        }
+
+        target.job = nullptr;
+    }
+
+    /** Returns a spare job, or a new one if there is none. Called with the lock held. */
+    std::shared_ptr<Job> createJob()
+    {
+        if (spareJobs.empty())
+            return std::make_shared<Job>();
+
+        auto job = std::move (spareJobs.back());
+        spareJobs.pop_back();
+        return job;
+    }
+
+    /** Keeps a job for reuse if nothing else refers to it, and clears the pointer.
+        Called with the lock held.
+    */
+    void recycle (std::shared_ptr<Job>& job)
+    {
+        // only the caller's pointer is left, so no other thread can take a new one
+        if (job.use_count() == 1 && spareJobs.size() < maxSpareJobs)
+        {
+            job->render = nullptr;
+            job->targets.clear();
+            job->started = false;
+            spareJobs.push_back (std::move (job));
+        }
+
+        job = nullptr;
+    }
+
+    /** Returns the number of workers to start for the queued jobs. */
+    int reserveWorkers()
+    {
+        const juce::ScopedLock sl (lock);
+
+        auto numQueued = (int) std::count_if (jobs.begin(), jobs.end(), [] (const auto& j) { return ! j->started; });
+        auto numToStart = juce::jmax (0, juce::jmin (maxRunning, numQueued) - numRunning);
+
+        numRunning += numToStart;
+        return numToStart;
+    }
+
+    /** Returns the most urgent job, waiting a while for one to be queued. Returns
+        nullptr once the worker should end, having taken it off the running count.
+    */
+    std::shared_ptr<Job> takeNextJob()
+    {
+        for (auto waited = false; ; waited = true)
+        {
+            {
+                const juce::ScopedLock sl (lock);
+
+                std::shared_ptr<Job> next;
+
+                if (! shutDown)
+                    for (auto& j : jobs)
+                        if (! j->started && (next == nullptr || std::tie (j->priority, j->sequence) < std::tie (next->priority, next->sequence)))
+                            next = j;
+
+                if (next != nullptr)
+                {
+                    next->started = true;
+                    return next;
+                }
+
+                if (shutDown || waited)
+                {
+                    --numRunning;
+                    return nullptr;
+                }
+            }
+
+            jobQueued.wait (workerIdleMs);
+        }
+    }
+
+    void finish (std::shared_ptr<Job> job, juce::Image image)
+    {
+        const juce::ScopedLock sl (lock);
+
+        if (deliverer == nullptr)
+            return;
+
+        finished.emplace_back (std::move (job), std::move (image));
+        deliverer->triggerAsyncUpdate();
+    }
+
+    void deliver (std::shared_ptr<Job>& job, const juce::Image& image)
+    {
+        deliveredTargets.clear();
+
+        {
+            const juce::ScopedLock sl (lock);
+
+            jobs.erase (std::remove (jobs.begin(), jobs.end(), job), jobs.end());
+
+            for (auto* t : job->targets)
+                t->job = nullptr;
+
+            deliveredTargets.swap (job->targets);
+        }
+
+        // targets detach themselves when they are deleted, which happens on the message thread, so these are all alive
+        for (auto* t : deliveredTargets)
+            if (t->onRenderFinished != nullptr)
+                t->onRenderFinished (image);
+
+        const juce::ScopedLock sl (lock);
+
+        // the job keeps the list it was given, so neither grows again
+        job->targets.swap (deliveredTargets);
+        recycle (job);
+    }
+};
+
+//==============================================================================
+RenderScheduler::Target::Target()
+{
+}
+
+RenderScheduler::Target::~Target()
+{
+    cancelRender();
+}
+
+void RenderScheduler::Target::requestRender (Priority priority, juce::int64 key, RenderFunction render)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    scheduler->queue->submit (*this, priority, key, std::move (render));
+    scheduler->startJobs();
+}
+
+void RenderScheduler::Target::cancelRender()
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    scheduler->queue->detach (*this);
+}
+
+bool RenderScheduler::Target::isRenderPending() const
+{
+    return job != nullptr;
+}
+
+//==============================================================================
+RenderScheduler::RenderScheduler()
+    : queue (std::make_shared<Queue>())
+{
+    // leave a thread free for the parallel loops of the other bulk operations
+    queue->maxRunning = juce::jmax (1, workers->getThreadPool().getNumThreads() - 1);
+    queue->deliverer = this;
+}
+
+RenderScheduler::~RenderScheduler()
+{
+    // running jobs finish their current render, and their results are dropped
+    {
+        const juce::ScopedLock sl (queue->lock);
+        queue->shutDown = true;
+        queue->deliverer = nullptr;
+        queue->jobs.clear();
+        queue->finished.clear();
+    }
+
+    queue->jobQueued.signal();
+    cancelPendingUpdate();
+}
+
+int RenderScheduler::getNumJobs() const
+{
+    const juce::ScopedLock sl (queue->lock);
+    return int (queue->jobs.size());
+}
+
+void RenderScheduler::startJobs()
+{
+    for (int i = queue->reserveWorkers(); --i >= 0;)
+    {
+        workers->getThreadPool().addJob ([q = queue]
+        {
+            while (auto job = q->takeNextJob())
+            {
+                auto image = job->render();
+                q->finish (std::move (job), std::move (image));
+            }
+        });
+    }
+}
+
+void RenderScheduler::handleAsyncUpdate()
+{
+    auto& delivering = queue->delivering;
+
+    {
+        const juce::ScopedLock sl (queue->lock);
+        delivering.swap (queue->finished);
+    }
+
+    for (auto& [job, image] : delivering)
+        queue->deliver (job, image);
+
+    delivering.clear();
+}
+
+} // namespace reFX
@@ -0,0 +1,103 @@
+#pragma once
+
+namespace reFX
+{
+
+//==============================================================================
+/**
+    Renders images in the background for all the ColourSelectors in a process.
+
+    Each component that renders through the scheduler owns a Target. Requests
+    are queued by priority, so the selector the user is working with is served
+    before the ones that are merely visible. Requests with the same key are merged into one job, whose
+    result goes to every target that asked for it, and a new request from a
+    target supersedes its previous one: a job that hasn't started is dropped,
+    and the result of one that has is discarded.
+
+    The jobs run on the shared WorkerPool, and results are delivered on the
+    message thread. The scheduler is shared through a
+    juce::SharedResourcePointer, which every Target holds.
+
+    Once the first few requests have been made, a request doesn't allocate:
+    the render functions are stored in place, finished jobs are reused, and
+    workers wait for a while for the next request rather than ending, so a
+    drag doesn't start a pool job for each frame.
+
+    @tags{GUI}
+*/
+class RenderScheduler  : private juce::AsyncUpdater
+{
+    struct Job;
+    struct Queue;
+
+public:
+    //==============================================================================
+    enum class Priority
+    {
+        interacting,    /**< the user is dragging in or has focused the selector */
+        visible,        /**< the component is on screen */
+    };
+
+    /** Renders an image on a worker thread. It mustn't refer to any component,
+        as it can run after the component that requested it has gone.
+
+        What it captures is stored in place, and must fit in maxRenderCapture bytes.
+    */
+    static constexpr size_t maxRenderCapture = 256;
+    using RenderFunction = juce::FixedSizeFunction<maxRenderCapture, juce::Image()>;
+
+    //==============================================================================
+    /** Something that renders images through the scheduler.
+
+        All its functions must be called on the message thread. Deleting it
+        cancels its request.
+    */
+    class Target
+    {
+    public:
+        Target();
+        ~Target();
+
+        /** Requests an image. The key must identify the image the function renders. */
+        void requestRender (Priority priority, juce::int64 key, RenderFunction render);
+
+        /** Cancels the current request, if there is one. */
+        void cancelRender();
+
+        /** Returns true if a requested image hasn't been delivered yet. */
+        bool isRenderPending() const;
+
+        /** Called on the message thread with the image of the most recent request. */
+        std::function<void (const juce::Image&)> onRenderFinished;
+
+    private:
+        friend class RenderScheduler;
+        friend struct Queue;
+
+        juce::SharedResourcePointer<RenderScheduler> scheduler;
+        std::shared_ptr<Job> job;
+
+        JUCE_DECLARE_NON_COPYABLE (Target)
+    };
+
+    //==============================================================================
+    RenderScheduler();
+    ~RenderScheduler() override;
+
+    /** Returns the number of jobs that are queued or running. */
+    int getNumJobs() const;
+
+private:
+    //==============================================================================
+    juce::SharedResourcePointer<WorkerPool> workers;
+
+    // shared with the running jobs, which can outlive the scheduler
+    std::shared_ptr<Queue> queue;
+
+    void startJobs();
+    void handleAsyncUpdate() override;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RenderScheduler)
+};
+
+} // namespace reFX
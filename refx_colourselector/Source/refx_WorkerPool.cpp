@@ -0,0 +1,69 @@
+namespace reFX
+{
+
+//==============================================================================
+WorkerPool::WorkerPool()
+    : pool (juce::jmax (1, juce::SystemStats::getNumCpus() - 1))
+{
+}
+
+WorkerPool::~WorkerPool()
+{
+    pool.removeAllJobs (true, -1);
+}
+
+int WorkerPool::getNumWorkers() const noexcept
+{
+    return pool.getNumThreads() + 1;
+}
+
+void WorkerPool::parallelFor (int numItems, int minChunkSize, const std::function<void (int, int)>& function)
+{
+    if (numItems <= 0)
+        return;
+
+    auto numChunks = juce::jlimit (1, getNumWorkers() * 4, numItems / juce::jmax (1, minChunkSize));
+
+    if (numChunks == 1)
+    {
+        function (0, numItems);
+        return;
+    }
+
+    // Jobs that only start after all chunks have been taken return without touching
+    // the function, so the state is shared with them but the function isn't copied
+    struct State
+    {
+        std::atomic<int> nextChunk { 0 };
+        std::atomic<int> chunksDone { 0 };
+        juce::WaitableEvent finished;
+    };
+
+    auto state = std::make_shared<State>();
+    auto* fn = &function;
+
+    auto runChunks = [state, fn, numItems, numChunks]
+    {
+        for (;;)
+        {
+            auto chunk = state->nextChunk++;
+
+            if (chunk >= numChunks)
+                return;
+
+            (*fn) (int (juce::int64 (numItems) * chunk / numChunks),
+                   int (juce::int64 (numItems) * (chunk + 1) / numChunks));
+
+            if (++state->chunksDone == numChunks)
+                state->finished.signal();
+        }
+    };
+
+    for (int i = 0; i < juce::jmin (numChunks - 1, pool.getNumThreads()); ++i)
+        pool.addJob (runChunks);
+
+    runChunks();
+    state->finished.wait();
+}
+
+} // namespace reFX
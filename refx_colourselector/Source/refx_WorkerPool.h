@@ -0,0 +1,44 @@
+#pragma once
+
+namespace reFX
+{
+
+//==============================================================================
+/**
+    A pool of worker threads shared by the bulk colour operations.
+
+    Get hold of it with a juce::SharedResourcePointer<WorkerPool>. The threads
+    are started when the first pointer is created, and stopped when the last
+    one is deleted.
+
+    @tags{Core}
+*/
+class WorkerPool
+{
+public:
+    //==============================================================================
+    WorkerPool();
+    ~WorkerPool();
+
+    /** Returns the number of threads that work on a parallelFor(), including the calling thread. */
+    int getNumWorkers() const noexcept;
+
+    /** Splits the range [0, numItems) into chunks of at least minChunkSize items and
+        calls the function for each chunk, on the pool's threads and the calling thread.
+
+        Returns once every chunk has been processed. It is safe to call this from
+        one of the pool's own threads.
+    */
+    void parallelFor (int numItems, int minChunkSize, const std::function<void (int begin, int end)>& function);
+
+    /** Returns the underlying thread pool, for jobs that run asynchronously. */
+    juce::ThreadPool& getThreadPool() noexcept          { return pool; }
+
+private:
+    //==============================================================================
+    juce::ThreadPool pool;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WorkerPool)
+};
+
+} // namespace reFX
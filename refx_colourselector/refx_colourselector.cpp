@@ -13,4 +13,18 @@
 
 #include "Source/refx_ColourSelectorLF.cpp"
 #include "Source/refx_DeepColour.cpp"
+#include "Source/refx_ColourDifference.cpp"
+#include "Source/refx_NamedColours.cpp"
+#include "Source/refx_RasterCache.cpp"
+#include "Source/refx_GradientLUT.cpp"
+#include "Source/refx_WorkerPool.cpp"
+#include "Source/refx_RenderScheduler.cpp"
+#include "Source/refx_RenderQualityGovernor.cpp"
+#include "Source/refx_PaletteExtractor.cpp"
+#include "Source/refx_ColourHistogram.cpp"
+#include "Source/refx_ColourVision.cpp"
+#include "Source/refx_ImageAdjuster.cpp"
+#include "Source/refx_ColourModel.cpp"
 #include "Source/refx_ColourSelector.cpp"
+#include "Source/refx_DragTrace.cpp"
+#include "Source/refx_ImageEyedropper.cpp"
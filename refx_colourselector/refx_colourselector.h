@@ -24,7 +24,9 @@
 #pragma once
 #define REFX_COLORPICKER_H_INCLUDED
 
+#include <array>
 #include <optional>
+#include <string_view>
 #include <unordered_map>
 
 #include <juce_core/juce_core.h>
@@ -32,4 +34,18 @@
 
 #include "Source/refx_ColourSelectorLF.h"
 #include "Source/refx_DeepColour.h"
+#include "Source/refx_ColourDifference.h"
+#include "Source/refx_NamedColours.h"
+#include "Source/refx_RasterCache.h"
+#include "Source/refx_GradientLUT.h"
+#include "Source/refx_WorkerPool.h"
+#include "Source/refx_RenderScheduler.h"
+#include "Source/refx_RenderQualityGovernor.h"
+#include "Source/refx_PaletteExtractor.h"
+#include "Source/refx_ColourHistogram.h"
+#include "Source/refx_ColourVision.h"
+#include "Source/refx_ImageAdjuster.h"
+#include "Source/refx_ColourModel.h"
 #include "Source/refx_ColourSelector.h"
+#include "Source/refx_DragTrace.h"
+#include "Source/refx_ImageEyedropper.h"